@@ -0,0 +1,85 @@
+#ifndef deflex_h
+#define deflex_h
+
+/**
+ * Declares the signature of native objective functions.
+ *
+ * A native objective function is passed to the DE routine as an
+ * external pointer to a variable of this type, for example:
+ *
+ *     double sphere (const double* x, int n, void* data) { ... }
+ *
+ *     // [[Rcpp::export]]
+ *     Rcpp::XPtr<deflex_objective> sphere_xptr () {
+ *       return Rcpp::XPtr<deflex_objective>(new deflex_objective(&sphere));
+ *     }
+ *
+ * The function must not call into R.
+ *
+ * @param x    Parameter vector to be evaluated.
+ * @param n    Number of parameters.
+ * @param data User data as given to the DE routine.
+ * @return Objective score.
+ */
+typedef double (*deflex_objective)(const double* x, int n, void* data);
+
+/**
+ * Declares incremental (delta) objective functions of separable or
+ * partially separable objectives, such as sums of per-parameter or
+ * per-block cost terms.
+ *
+ * Each member of the population carries `size` doubles of partial
+ * state (for example, the block sums) along with its score. The first
+ * evaluation of a member computes its score and partial state from
+ * scratch. A trial is then evaluated from its candidate (the parent),
+ * given the elements of the trial which differ from the parent, which
+ * is close to O(k) for k changed elements instead of O(n):
+ *
+ *     double evaluate (const double* x, int n, double* state, void* data) { ... }
+ *     double update (const double* x, int n, const int* changed, int count,
+ *                    const double* parent, double score, const double* state, double* next, void* data) { ... }
+ *
+ *     // [[Rcpp::export]]
+ *     Rcpp::XPtr<deflex_delta> sum_delta_xptr () {
+ *       deflex_delta delta = { 0, &evaluate, &update };
+ *       return Rcpp::XPtr<deflex_delta>(new deflex_delta(delta));
+ *     }
+ *
+ * The functions must not call into R.
+ */
+typedef struct {
+  /**
+   * Number of doubles of partial state per member (may be 0).
+   */
+  int size;
+
+  /**
+   * Evaluates x from scratch.
+   *
+   * @param x     Parameter vector to be evaluated.
+   * @param n     Number of parameters.
+   * @param state Partial state of x (output).
+   * @param data  User data as given to the DE routine.
+   * @return Objective score.
+   */
+  double (*evaluate)(const double* x, int n, double* state, void* data);
+
+  /**
+   * Evaluates x from its parent.
+   *
+   * @param x       Parameter vector to be evaluated.
+   * @param n       Number of parameters.
+   * @param changed Ascending indices of the elements of x which differ from the parent.
+   * @param count   Number of changed elements, at least 1.
+   * @param parent  Parameter vector of the parent.
+   * @param score   Objective score of the parent.
+   * @param state   Partial state of the parent.
+   * @param next    Partial state of x (output).
+   * @param data    User data as given to the DE routine.
+   * @return Objective score.
+   */
+  double (*update)(const double* x, int n, const int* changed, int count,
+                   const double* parent, double score, const double* state, double* next, void* data);
+} deflex_delta;
+
+#endif
@@ -10,13 +10,97 @@ Rcpp::Rostream<true>&  Rcpp::Rcout = Rcpp::Rcpp_cout_get();
 Rcpp::Rostream<false>& Rcpp::Rcerr = Rcpp::Rcpp_cerr_get();
 #endif
 
+// deflex_benchmark
+Rcpp::List deflex_benchmark(std::string name, SEXP shift, SEXP rotation);
+RcppExport SEXP _deflex_deflex_benchmark(SEXP nameSEXP, SEXP shiftSEXP, SEXP rotationSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< std::string >::type name(nameSEXP);
+    Rcpp::traits::input_parameter< SEXP >::type shift(shiftSEXP);
+    Rcpp::traits::input_parameter< SEXP >::type rotation(rotationSEXP);
+    rcpp_result_gen = Rcpp::wrap(deflex_benchmark(name, shift, rotation));
+    return rcpp_result_gen;
+END_RCPP
+}
+// deflex_benchmark_cost
+double deflex_benchmark_cost(SEXP objective, SEXP data, Rcpp::NumericMatrix points, int repeats);
+RcppExport SEXP _deflex_deflex_benchmark_cost(SEXP objectiveSEXP, SEXP dataSEXP, SEXP pointsSEXP, SEXP repeatsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type objective(objectiveSEXP);
+    Rcpp::traits::input_parameter< SEXP >::type data(dataSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericMatrix >::type points(pointsSEXP);
+    Rcpp::traits::input_parameter< int >::type repeats(repeatsSEXP);
+    rcpp_result_gen = Rcpp::wrap(deflex_benchmark_cost(objective, data, points, repeats));
+    return rcpp_result_gen;
+END_RCPP
+}
+// deflex_peak_memory
+double deflex_peak_memory(bool reset);
+RcppExport SEXP _deflex_deflex_peak_memory(SEXP resetSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< bool >::type reset(resetSEXP);
+    rcpp_result_gen = Rcpp::wrap(deflex_peak_memory(reset));
+    return rcpp_result_gen;
+END_RCPP
+}
 // deflex_strategy3
-SEXP deflex_strategy3(Rcpp::Function objective, Rcpp::NumericVector lower, Rcpp::NumericVector upper, Rcpp::NumericMatrix initpop, int iterations, double cr, double f, double c, double jf, bool bounceBack, double precision);
-RcppExport SEXP _deflex_deflex_strategy3(SEXP objectiveSEXP, SEXP lowerSEXP, SEXP upperSEXP, SEXP initpopSEXP, SEXP iterationsSEXP, SEXP crSEXP, SEXP fSEXP, SEXP cSEXP, SEXP jfSEXP, SEXP bounceBackSEXP, SEXP precisionSEXP) {
+SEXP deflex_strategy3(SEXP objective, Rcpp::NumericVector lower, Rcpp::NumericVector upper, Rcpp::NumericMatrix initpop, int iterations, double cr, double f, double c, double jf, bool bounceBack, double precision, Rcpp::List control);
+RcppExport SEXP _deflex_deflex_strategy3(SEXP objectiveSEXP, SEXP lowerSEXP, SEXP upperSEXP, SEXP initpopSEXP, SEXP iterationsSEXP, SEXP crSEXP, SEXP fSEXP, SEXP cSEXP, SEXP jfSEXP, SEXP bounceBackSEXP, SEXP precisionSEXP, SEXP controlSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type objective(objectiveSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type lower(lowerSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type upper(upperSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericMatrix >::type initpop(initpopSEXP);
+    Rcpp::traits::input_parameter< int >::type iterations(iterationsSEXP);
+    Rcpp::traits::input_parameter< double >::type cr(crSEXP);
+    Rcpp::traits::input_parameter< double >::type f(fSEXP);
+    Rcpp::traits::input_parameter< double >::type c(cSEXP);
+    Rcpp::traits::input_parameter< double >::type jf(jfSEXP);
+    Rcpp::traits::input_parameter< bool >::type bounceBack(bounceBackSEXP);
+    Rcpp::traits::input_parameter< double >::type precision(precisionSEXP);
+    Rcpp::traits::input_parameter< Rcpp::List >::type control(controlSEXP);
+    rcpp_result_gen = Rcpp::wrap(deflex_strategy3(objective, lower, upper, initpop, iterations, cr, f, c, jf, bounceBack, precision, control));
+    return rcpp_result_gen;
+END_RCPP
+}
+
+// deflex_resume
+SEXP deflex_resume(SEXP objective, Rcpp::NumericVector lower, Rcpp::NumericVector upper, std::string checkpoint, int iterations, double cr, double f, double c, double jf, bool bounceBack, double precision, Rcpp::List control);
+RcppExport SEXP _deflex_deflex_resume(SEXP objectiveSEXP, SEXP lowerSEXP, SEXP upperSEXP, SEXP checkpointSEXP, SEXP iterationsSEXP, SEXP crSEXP, SEXP fSEXP, SEXP cSEXP, SEXP jfSEXP, SEXP bounceBackSEXP, SEXP precisionSEXP, SEXP controlSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type objective(objectiveSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type lower(lowerSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type upper(upperSEXP);
+    Rcpp::traits::input_parameter< std::string >::type checkpoint(checkpointSEXP);
+    Rcpp::traits::input_parameter< int >::type iterations(iterationsSEXP);
+    Rcpp::traits::input_parameter< double >::type cr(crSEXP);
+    Rcpp::traits::input_parameter< double >::type f(fSEXP);
+    Rcpp::traits::input_parameter< double >::type c(cSEXP);
+    Rcpp::traits::input_parameter< double >::type jf(jfSEXP);
+    Rcpp::traits::input_parameter< bool >::type bounceBack(bounceBackSEXP);
+    Rcpp::traits::input_parameter< double >::type precision(precisionSEXP);
+    Rcpp::traits::input_parameter< Rcpp::List >::type control(controlSEXP);
+    rcpp_result_gen = Rcpp::wrap(deflex_resume(objective, lower, upper, checkpoint, iterations, cr, f, c, jf, bounceBack, precision, control));
+    return rcpp_result_gen;
+END_RCPP
+}
+
+// deflex_islands
+SEXP deflex_islands(SEXP objective, Rcpp::NumericVector lower, Rcpp::NumericVector upper, Rcpp::NumericMatrix initpop, int iterations, double cr, double f, double c, double jf, bool bounceBack, double precision, int islands, Rcpp::List control);
+RcppExport SEXP _deflex_deflex_islands(SEXP objectiveSEXP, SEXP lowerSEXP, SEXP upperSEXP, SEXP initpopSEXP, SEXP iterationsSEXP, SEXP crSEXP, SEXP fSEXP, SEXP cSEXP, SEXP jfSEXP, SEXP bounceBackSEXP, SEXP precisionSEXP, SEXP islandsSEXP, SEXP controlSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
-    Rcpp::traits::input_parameter< Rcpp::Function >::type objective(objectiveSEXP);
+    Rcpp::traits::input_parameter< SEXP >::type objective(objectiveSEXP);
     Rcpp::traits::input_parameter< Rcpp::NumericVector >::type lower(lowerSEXP);
     Rcpp::traits::input_parameter< Rcpp::NumericVector >::type upper(upperSEXP);
     Rcpp::traits::input_parameter< Rcpp::NumericMatrix >::type initpop(initpopSEXP);
@@ -27,13 +111,100 @@ BEGIN_RCPP
     Rcpp::traits::input_parameter< double >::type jf(jfSEXP);
     Rcpp::traits::input_parameter< bool >::type bounceBack(bounceBackSEXP);
     Rcpp::traits::input_parameter< double >::type precision(precisionSEXP);
-    rcpp_result_gen = Rcpp::wrap(deflex_strategy3(objective, lower, upper, initpop, iterations, cr, f, c, jf, bounceBack, precision));
+    Rcpp::traits::input_parameter< int >::type islands(islandsSEXP);
+    Rcpp::traits::input_parameter< Rcpp::List >::type control(controlSEXP);
+    rcpp_result_gen = Rcpp::wrap(deflex_islands(objective, lower, upper, initpop, iterations, cr, f, c, jf, bounceBack, precision, islands, control));
+    return rcpp_result_gen;
+END_RCPP
+}
+
+// deflex_async
+SEXP deflex_async(SEXP objective, Rcpp::NumericVector lower, Rcpp::NumericVector upper, Rcpp::NumericMatrix initpop, int iterations, double cr, double f, double c, double jf, bool bounceBack, double precision, Rcpp::List control);
+RcppExport SEXP _deflex_deflex_async(SEXP objectiveSEXP, SEXP lowerSEXP, SEXP upperSEXP, SEXP initpopSEXP, SEXP iterationsSEXP, SEXP crSEXP, SEXP fSEXP, SEXP cSEXP, SEXP jfSEXP, SEXP bounceBackSEXP, SEXP precisionSEXP, SEXP controlSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type objective(objectiveSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type lower(lowerSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type upper(upperSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericMatrix >::type initpop(initpopSEXP);
+    Rcpp::traits::input_parameter< int >::type iterations(iterationsSEXP);
+    Rcpp::traits::input_parameter< double >::type cr(crSEXP);
+    Rcpp::traits::input_parameter< double >::type f(fSEXP);
+    Rcpp::traits::input_parameter< double >::type c(cSEXP);
+    Rcpp::traits::input_parameter< double >::type jf(jfSEXP);
+    Rcpp::traits::input_parameter< bool >::type bounceBack(bounceBackSEXP);
+    Rcpp::traits::input_parameter< double >::type precision(precisionSEXP);
+    Rcpp::traits::input_parameter< Rcpp::List >::type control(controlSEXP);
+    rcpp_result_gen = Rcpp::wrap(deflex_async(objective, lower, upper, initpop, iterations, cr, f, c, jf, bounceBack, precision, control));
+    return rcpp_result_gen;
+END_RCPP
+}
+
+// deflex_batch
+SEXP deflex_batch(Rcpp::List jobs, int threads);
+RcppExport SEXP _deflex_deflex_batch(SEXP jobsSEXP, SEXP threadsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< Rcpp::List >::type jobs(jobsSEXP);
+    Rcpp::traits::input_parameter< int >::type threads(threadsSEXP);
+    rcpp_result_gen = Rcpp::wrap(deflex_batch(jobs, threads));
+    return rcpp_result_gen;
+END_RCPP
+}
+
+// deflex_initpop
+Rcpp::NumericMatrix deflex_initpop(Rcpp::NumericVector lower, Rcpp::NumericVector upper, int popsize, std::string generator, double seed);
+RcppExport SEXP _deflex_deflex_initpop(SEXP lowerSEXP, SEXP upperSEXP, SEXP popsizeSEXP, SEXP generatorSEXP, SEXP seedSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type lower(lowerSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type upper(upperSEXP);
+    Rcpp::traits::input_parameter< int >::type popsize(popsizeSEXP);
+    Rcpp::traits::input_parameter< std::string >::type generator(generatorSEXP);
+    Rcpp::traits::input_parameter< double >::type seed(seedSEXP);
+    rcpp_result_gen = Rcpp::wrap(deflex_initpop(lower, upper, popsize, generator, seed));
+    return rcpp_result_gen;
+END_RCPP
+}
+
+// deflex_strategy3_generated
+SEXP deflex_strategy3_generated(SEXP objective, Rcpp::NumericVector lower, Rcpp::NumericVector upper, int popsize, std::string generator, int iterations, double cr, double f, double c, double jf, bool bounceBack, double precision, Rcpp::List control);
+RcppExport SEXP _deflex_deflex_strategy3_generated(SEXP objectiveSEXP, SEXP lowerSEXP, SEXP upperSEXP, SEXP popsizeSEXP, SEXP generatorSEXP, SEXP iterationsSEXP, SEXP crSEXP, SEXP fSEXP, SEXP cSEXP, SEXP jfSEXP, SEXP bounceBackSEXP, SEXP precisionSEXP, SEXP controlSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type objective(objectiveSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type lower(lowerSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type upper(upperSEXP);
+    Rcpp::traits::input_parameter< int >::type popsize(popsizeSEXP);
+    Rcpp::traits::input_parameter< std::string >::type generator(generatorSEXP);
+    Rcpp::traits::input_parameter< int >::type iterations(iterationsSEXP);
+    Rcpp::traits::input_parameter< double >::type cr(crSEXP);
+    Rcpp::traits::input_parameter< double >::type f(fSEXP);
+    Rcpp::traits::input_parameter< double >::type c(cSEXP);
+    Rcpp::traits::input_parameter< double >::type jf(jfSEXP);
+    Rcpp::traits::input_parameter< bool >::type bounceBack(bounceBackSEXP);
+    Rcpp::traits::input_parameter< double >::type precision(precisionSEXP);
+    Rcpp::traits::input_parameter< Rcpp::List >::type control(controlSEXP);
+    rcpp_result_gen = Rcpp::wrap(deflex_strategy3_generated(objective, lower, upper, popsize, generator, iterations, cr, f, c, jf, bounceBack, precision, control));
     return rcpp_result_gen;
 END_RCPP
 }
 
 static const R_CallMethodDef CallEntries[] = {
-    {"_deflex_deflex_strategy3", (DL_FUNC) &_deflex_deflex_strategy3, 11},
+    {"_deflex_deflex_benchmark", (DL_FUNC) &_deflex_deflex_benchmark, 3},
+    {"_deflex_deflex_benchmark_cost", (DL_FUNC) &_deflex_deflex_benchmark_cost, 4},
+    {"_deflex_deflex_peak_memory", (DL_FUNC) &_deflex_deflex_peak_memory, 1},
+    {"_deflex_deflex_strategy3", (DL_FUNC) &_deflex_deflex_strategy3, 12},
+    {"_deflex_deflex_resume", (DL_FUNC) &_deflex_deflex_resume, 12},
+    {"_deflex_deflex_islands", (DL_FUNC) &_deflex_deflex_islands, 13},
+    {"_deflex_deflex_async", (DL_FUNC) &_deflex_deflex_async, 12},
+    {"_deflex_deflex_batch", (DL_FUNC) &_deflex_deflex_batch, 2},
+    {"_deflex_deflex_initpop", (DL_FUNC) &_deflex_deflex_initpop, 5},
+    {"_deflex_deflex_strategy3_generated", (DL_FUNC) &_deflex_deflex_strategy3_generated, 13},
     {NULL, NULL, 0}
 };
 
@@ -0,0 +1,205 @@
+#include <chrono>
+#include <memory>
+#include <cmath>
+#include <limits>
+#include <algorithm>
+#include <stdexcept>
+#include "batch.h"
+#include "engine.h"
+#include "reduction.h"
+
+Job parseJob (const Rcpp::List spec) {
+  // Check the elements:
+  const char* names[] = { "objective", "lower", "upper", "initpop", "iterations", "cr", "f", "c", "jf", "bounceBack", "precision" };
+  for (size_t i = 0; i < sizeof(names) / sizeof(names[0]); i++) {
+    if (!spec.containsElementNamed(names[i])) {
+      Rcpp::stop(std::string("Job is missing the element: ") + names[i]);
+    }
+  }
+
+  // Parse optional settings:
+  Job job;
+  const Rcpp::List control = spec.containsElementNamed("control") ? Rcpp::List(spec["control"]) : Rcpp::List::create();
+  job.settings = parseControl(control);
+  const Control& settings = job.settings;
+
+  // Settings with which the single-threaded DE routine evolves or counts evaluations differently are not supported:
+  rejectControl(control, {"processes", "cache", "surrogate"}, "batches");
+  if (settings.threads > 1) {
+    Rcpp::stop("Multi-threaded jobs are not supported in batches, use the `threads` argument instead.");
+  }
+
+  // Get the objective function, and the constraint function, if any:
+  job.objective = createObjective(spec["objective"], settings.data, settings.batch, settings.feasibilityTolerance);
+  job.constraint = createConstraint(settings.constraint, settings.data, parseConstraintHandling(settings.constraintHandling),
+                                    settings.penalty, settings.feasibilityTolerance);
+  if (!Rf_isNull(settings.delta)) {
+    Rcpp::stop("Incremental objective functions are not supported in batches.");
+  }
+
+  // Get the bounds and the initial population:
+  Rcpp::NumericVector lower(spec["lower"]);
+  Rcpp::NumericVector upper(spec["upper"]);
+  Rcpp::NumericMatrix initpop(spec["initpop"]);
+  if (lower.size() != upper.size() || initpop.ncol() != upper.size()) {
+    Rcpp::stop("Bounds and the initial population must be of the same dimension.");
+  }
+  job.lower.assign(lower.begin(), lower.end());
+  job.upper.assign(upper.begin(), upper.end());
+  job.initpop.assign(initpop.begin(), initpop.end());
+  job.popsize = initpop.nrow();
+
+  // Get the DE settings:
+  job.iterations = Rcpp::as<int>(spec["iterations"]);
+  job.cr = Rcpp::as<double>(spec["cr"]);
+  job.f = Rcpp::as<double>(spec["f"]);
+  job.c = Rcpp::as<double>(spec["c"]);
+  job.jf = Rcpp::as<double>(spec["jf"]);
+  job.precision = Rcpp::as<double>(spec["precision"]);
+  job.mutation = parseMutation(settings.mutation);
+  job.crossover = parseCrossover(settings.crossover);
+  job.boundary = parseBoundary(settings.boundary, Rcpp::as<bool>(spec["bounceBack"]));
+  job.kernels = &selectKernels(settings.simd);
+  job.layout = parseLayout(settings.layout);
+
+  // We need enough candidates to pick the candidate and its donors:
+  if (job.popsize < donorCount(job.mutation) + 1) {
+    Rcpp::stop("Population size must be at least " + std::to_string(donorCount(job.mutation) + 1) + ".");
+  }
+
+  // Check the lattice, if requested:
+  if (settings.lattice) {
+    Lattice(job.lower.size(), job.lower.data(), job.upper.data(), job.precision);
+  }
+
+  // Check the population size reduction:
+  Reduction(parseReduction(settings.reduction), job.popsize, settings.minPopsize, job.iterations, settings.maxEvaluations,
+            settings.popsizes, donorCount(job.mutation) + 1);
+
+  // Get the random number generator, always an internal one, and the seed:
+  job.rngKind = parseRngKind(settings.rng);
+  if (job.rngKind == RNG_R) {
+    job.rngKind = RNG_XOSHIRO;
+  }
+  job.seed = parseSeed(settings.seed);
+
+  // Done, return:
+  return job;
+}
+
+
+double jobCost (const Job& job) {
+  const double generations = std::min(static_cast<double>(job.iterations), job.settings.maxEvaluations / job.popsize);
+  return generations * job.popsize * job.lower.size();
+}
+
+
+/**
+ * Evaluates the native objective function without touching R objects.
+ *
+ * @return The objective score.
+ */
+static double evaluateSafely (const Objective& objective, const double* candidate, int dimension) {
+  const double score = objective.native(candidate, dimension, objective.data);
+  if (std::isnan(score)) {
+    throw std::runtime_error("NaN value of objective function! \nPerhaps adjust the bounds.");
+  }
+  return score;
+}
+
+
+Summary runJob (const Job& job) {
+  // Start the wall-clock, and checking the termination criteria:
+  const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  const Control& settings = job.settings;
+  Termination termination(settings.target, settings.stagnation, settings.scoreTolerance, settings.parameterTolerance, settings.maxEvaluations, settings.timeLimit);
+
+  // Define the problem and select the trial builder specialised for the strategy:
+  const int dimension = job.lower.size();
+  const std::unique_ptr<Lattice> lattice(settings.lattice ? new Lattice(dimension, job.lower.data(), job.upper.data(), job.precision) : NULL);
+  const Problem problem = { dimension, job.popsize, job.lower.data(), job.upper.data(), job.cr, job.f, job.c, job.jf,
+                            job.mutation, job.crossover, job.boundary, job.precision, job.kernels, lattice.get() };
+  const TrialBuilder<NoStats> build = selectBuilder<NoStats>(problem);
+
+  // Get the population size reduction schedule:
+  const Reduction reduction(parseReduction(settings.reduction), job.popsize, settings.minPopsize, job.iterations, settings.maxEvaluations,
+                            settings.popsizes, donorCount(job.mutation) + 1);
+
+  // Create the random number stream and scratch space, as the single-threaded DE routine does:
+  std::vector<Random> streams = createStreams(job.rngKind, job.seed, 1, std::max(256, 4 * job.popsize));
+  std::vector<double> scratch(SCRATCH_ROWS * dimension);
+
+  // Initialize the state, screening the initial population with the constraint function, if any:
+  State state(job.popsize, dimension, job.layout);
+  std::vector<double> initpop(job.initpop);
+  if (lattice.get() != NULL) {
+    lattice->snap(initpop.data(), job.popsize);
+  }
+  state.population.read(initpop.data());
+  std::vector<char> screened;
+  int infeasible = job.constraint.active() ? screenCandidates(job.constraint, state.population, state.scores, state.violations, screened) : 0;
+  if (job.objective.native != NULL) {
+    for (int i = 0; i < job.popsize; i++) {
+      if (infeasible > 0 && screened[i]) {
+        continue;
+      }
+      const double* member = state.population.row(i, scratch.data());
+      state.scores[i] = isFeasible(member, problem.lower, problem.upper, dimension, job.objective.tolerance) ?
+        evaluateSafely(job.objective, member, dimension) : std::numeric_limits<double>::infinity();
+    }
+  }
+  else {
+    Rcpp::NumericVector initialScores = evaluateObjectives(Rcpp::NumericMatrix(job.popsize, dimension, initpop.begin()), job.objective,
+                                                           Rcpp::NumericVector(job.lower.begin(), job.lower.end()),
+                                                           Rcpp::NumericVector(job.upper.begin(), job.upper.end()),
+                                                           NULL, infeasible > 0 ? screened.data() : NULL);
+    for (int i = 0; i < job.popsize; i++) {
+      if (infeasible == 0 || !screened[i]) {
+        state.scores[i] = initialScores[i];
+      }
+    }
+  }
+  state.findBest();
+  state.meanCR = job.cr;
+  state.meanF = job.f;
+
+  // Evolve until maximum generation count, ie. iterations, or until a termination criterion fires, counting evaluations
+  // as the single-threaded DE routine does without a cache, ie. one per feasible member:
+  double evaluations = job.popsize - infeasible;
+  int generation = 0;
+  Criterion criterion = termination.check(state.population, state.scores, state.bestScore, evaluations);
+  while (criterion == TERMINATE_NONE && ++generation < job.iterations + 1) {
+    // Build, screen and evaluate trials:
+    const int size = state.population.size();
+    buildTrials(build, streams[0], problem, state, 0, size, scratch.data());
+    infeasible = job.constraint.active() ? screenCandidates(job.constraint, state.trials, state.trialScores, state.trialViolations, screened) : 0;
+    if (job.objective.native != NULL) {
+      for (int candidate = 0; candidate < size; candidate++) {
+        if (infeasible == 0 || !screened[candidate]) {
+          state.trialScores[candidate] = evaluateSafely(job.objective, state.trials.row(candidate), dimension);
+        }
+      }
+    }
+    else {
+      evaluateTrials(state.trials, job.objective, R_GlobalEnv, NULL, state.trialScores, infeasible > 0 ? screened.data() : NULL);
+    }
+    evaluations += size - infeasible;
+
+    // Select the next generation, and shrink it if required:
+    selectTrials(problem, state);
+    if (reduction.enabled()) {
+      reducePopulation(state, reduction.size(generation, evaluations, size));
+    }
+    criterion = termination.check(state.population, state.scores, state.bestScore, evaluations);
+  }
+
+  // Done, return:
+  Summary summary;
+  summary.bestMember = state.bestMember;
+  summary.bestScore = state.bestScore;
+  summary.evaluations = evaluations;
+  summary.generations = criterion != TERMINATE_NONE ? generation : generation - 1;
+  summary.criterion = criterion;
+  summary.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  return summary;
+}
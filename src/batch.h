@@ -0,0 +1,161 @@
+#include <string>
+#include <vector>
+#include <stdint.h>
+#include <Rcpp.h>
+#include "control.h"
+#include "evaluate.h"
+#include "constraint.h"
+#include "strategy.h"
+#include "population.h"
+#include "kernels.h"
+#include "rng.h"
+#include "termination.h"
+
+#ifndef deflex_batch_h
+#define deflex_batch_h
+
+/**
+ * Provides an independent optimisation of a batch, parsed from R
+ * objects up front so that it runs without touching R objects unless
+ * its objective function is an R function.
+ */
+struct Job {
+  /**
+   * The objective function.
+   */
+  Objective objective;
+
+  /**
+   * The constraint function to screen candidates with, if any.
+   */
+  Constraint constraint;
+
+  /**
+   * Lower- and upper-bounds for each parameter.
+   */
+  std::vector<double> lower;
+  std::vector<double> upper;
+
+  /**
+   * The initial population in R's column-major matrix layout.
+   */
+  std::vector<double> initpop;
+
+  /**
+   * Population size.
+   */
+  int popsize;
+
+  /**
+   * Number of iterations.
+   */
+  int iterations;
+
+  /**
+   * DE settings (see `Problem`).
+   */
+  double cr;
+  double f;
+  double c;
+  double jf;
+  double precision;
+  Mutation mutation;
+  Crossover crossover;
+  Boundary boundary;
+  const Kernels* kernels;
+
+  /**
+   * Storage layout of the population.
+   */
+  Layout layout;
+
+  /**
+   * Random number generator kind (always an internal one) and seed.
+   */
+  RngKind rngKind;
+  uint64_t seed;
+
+  /**
+   * Optional settings for the termination criteria and the population
+   * size reduction.
+   */
+  Control settings;
+};
+
+
+/**
+ * Provides the compact summary of a job.
+ */
+struct Summary {
+  /**
+   * The best member and score.
+   */
+  std::vector<double> bestMember;
+  double bestScore;
+
+  /**
+   * Number of evaluations.
+   */
+  double evaluations;
+
+  /**
+   * Number of generations evolved.
+   */
+  int generations;
+
+  /**
+   * The termination criterion fired.
+   */
+  Criterion criterion;
+
+  /**
+   * Wall-clock time of the job in seconds.
+   */
+  double seconds;
+};
+
+
+/**
+ * Parses a job.
+ *
+ * It must be called from the main thread. R's random number generator
+ * is replaced with xoshiro256++, and the seed is drawn from R's random
+ * number generator unless given. Worker processes, caches, surrogate
+ * models, incremental objective functions and more than one thread per
+ * job are rejected as they change the evolution or the evaluation
+ * count. History, checkpoints and statistics are ignored.
+ *
+ * @param spec List with `objective`, `lower`, `upper`, `initpop`,
+ *             `iterations`, `cr`, `f`, `c`, `jf`, `bounceBack`,
+ *             `precision` and optional `control` elements, as the
+ *             arguments of `deflex_strategy3`.
+ * @return The job.
+ */
+Job parseJob (const Rcpp::List spec);
+
+
+/**
+ * Gives the estimated cost of a job to schedule expensive jobs first.
+ *
+ * @param job The job.
+ * @return Estimated number of trial elements built.
+ */
+double jobCost (const Job& job);
+
+
+/**
+ * Runs a job to the end on the calling thread.
+ *
+ * Jobs with native objective and constraint functions touch no R
+ * objects and can run on any thread, others must run on the main
+ * thread. The evolution, the number of evaluations and the termination
+ * are the same as the ones of the single-threaded DE routine with the
+ * same settings and seed, R objective functions being evaluated in the
+ * global environment likewise.
+ *
+ * @param job The job.
+ * @return The summary.
+ */
+Summary runJob (const Job& job);
+
+#endif
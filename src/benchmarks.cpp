@@ -0,0 +1,253 @@
+#include <cmath>
+#include <cstdlib>
+#include <chrono>
+#include <fstream>
+#include <limits>
+#include <Rcpp.h>
+#include "benchmarks.h"
+#include "evaluate.h"
+
+#ifndef _WIN32
+#include <sys/resource.h>
+#endif
+
+double benchmarkSphere (const double* x, int n, void* /*data*/) {
+  double sum = 0;
+  for (int i = 0; i < n; i++) {
+    sum += x[i] * x[i];
+  }
+  return sum;
+}
+
+
+double benchmarkRosenbrock (const double* x, int n, void* /*data*/) {
+  double sum = 0;
+  for (int i = 0; i < n - 1; i++) {
+    sum += 100 * std::pow(x[i + 1] - x[i] * x[i], 2) + std::pow(1 - x[i], 2);
+  }
+  return sum;
+}
+
+
+double benchmarkRastrigin (const double* x, int n, void* /*data*/) {
+  double sum = 10.0 * n;
+  for (int i = 0; i < n; i++) {
+    sum += x[i] * x[i] - 10 * std::cos(2 * M_PI * x[i]);
+  }
+  return sum;
+}
+
+
+double benchmarkAckley (const double* x, int n, void* /*data*/) {
+  double squares = 0;
+  double cosines = 0;
+  for (int i = 0; i < n; i++) {
+    squares += x[i] * x[i];
+    cosines += std::cos(2 * M_PI * x[i]);
+  }
+  return -20 * std::exp(-0.2 * std::sqrt(squares / n)) - std::exp(cosines / n) + 20 + M_E;
+}
+
+
+double benchmarkGriewank (const double* x, int n, void* /*data*/) {
+  double sum = 0;
+  double product = 1;
+  for (int i = 0; i < n; i++) {
+    sum += x[i] * x[i] / 4000;
+    product *= std::cos(x[i] / std::sqrt(i + 1.0));
+  }
+  return 1 + sum - product;
+}
+
+
+double benchmarkSchwefel (const double* x, int n, void* /*data*/) {
+  double sum = 418.9828872724338 * n;
+  for (int i = 0; i < n; i++) {
+    sum -= x[i] * std::sin(std::sqrt(std::abs(x[i])));
+  }
+  return sum;
+}
+
+
+deflex_objective findBenchmark (const std::string& name) {
+  if (name == "sphere") {
+    return benchmarkSphere;
+  }
+  else if (name == "rosenbrock") {
+    return benchmarkRosenbrock;
+  }
+  else if (name == "rastrigin") {
+    return benchmarkRastrigin;
+  }
+  else if (name == "ackley") {
+    return benchmarkAckley;
+  }
+  else if (name == "griewank") {
+    return benchmarkGriewank;
+  }
+  else if (name == "schwefel") {
+    return benchmarkSchwefel;
+  }
+  Rcpp::stop("Unknown benchmark function: " + name);
+}
+
+
+double benchmarkTransformed (const double* x, int n, void* data) {
+  const Transform& transform = *static_cast<const Transform*>(data);
+
+  // Check the dimension:
+  if ((!transform.shift.empty() && (int) transform.shift.size() != n) || (!transform.rotation.empty() && (int) transform.rotation.size() != n * n)) {
+    return std::numeric_limits<double>::quiet_NaN();
+  }
+
+  // Get the scratch space of the thread:
+  static thread_local std::vector<double> shifted;
+  static thread_local std::vector<double> rotated;
+  shifted.resize(n);
+
+  // Shift:
+  for (int i = 0; i < n; i++) {
+    shifted[i] = transform.shift.empty() ? x[i] : x[i] - transform.shift[i];
+  }
+
+  // Rotate, if required:
+  if (transform.rotation.empty()) {
+    return transform.base(shifted.data(), n, NULL);
+  }
+  rotated.assign(n, 0.0);
+  for (int j = 0; j < n; j++) {
+    const double* column = &transform.rotation[static_cast<size_t>(j) * n];
+    for (int i = 0; i < n; i++) {
+      rotated[i] += column[i] * shifted[j];
+    }
+  }
+  return transform.base(rotated.data(), n, NULL);
+}
+
+
+double peakMemory (bool reset) {
+#if defined(__linux__)
+  // Read the high water mark which, unlike the one getrusage gives, can be reset:
+  double retval = std::numeric_limits<double>::quiet_NaN();
+  std::ifstream status("/proc/self/status");
+  std::string line;
+  while (std::getline(status, line)) {
+    if (line.compare(0, 6, "VmHWM:") == 0) {
+      retval = std::atof(line.c_str() + 6) * 1024.0;
+    }
+  }
+  if (reset) {
+    std::ofstream("/proc/self/clear_refs") << "5";
+  }
+  return retval;
+#elif defined(_WIN32)
+  return std::numeric_limits<double>::quiet_NaN();
+#else
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) != 0) {
+    return std::numeric_limits<double>::quiet_NaN();
+  }
+#ifdef __APPLE__
+  return usage.ru_maxrss;
+#else
+  return usage.ru_maxrss * 1024.0;
+#endif
+#endif
+}
+
+
+/**
+ * Creates a benchmark function as a native objective function.
+ *
+ * For CEC-style variants, the function is evaluated at `rotation * (x -
+ * shift)`, and the user data to pass via `control$data` is returned as
+ * well.
+ *
+ * @param name     One of `"sphere"`, `"rosenbrock"`, `"rastrigin"`, `"ackley"`, `"griewank"` or `"schwefel"`.
+ * @param shift    The shift vector, or `NULL`.
+ * @param rotation The rotation matrix, or `NULL`.
+ * @return A list with the `objective` and the `data` (`NULL` unless shifted or rotated).
+ */
+// [[Rcpp::export]]
+Rcpp::List deflex_benchmark (std::string name, SEXP shift = R_NilValue, SEXP rotation = R_NilValue) {
+  // Get the base function:
+  const deflex_objective base = findBenchmark(name);
+
+  // Done if neither shifted nor rotated:
+  if (Rf_isNull(shift) && Rf_isNull(rotation)) {
+    return Rcpp::List::create(Rcpp::_["objective"] = Rcpp::XPtr<deflex_objective>(new deflex_objective(base)),
+                              Rcpp::_["data"] = R_NilValue);
+  }
+
+  // Create the transform:
+  Rcpp::XPtr<Transform> transform(new Transform());
+  transform->base = base;
+  if (!Rf_isNull(shift)) {
+    transform->shift = Rcpp::as<std::vector<double> >(shift);
+  }
+  if (!Rf_isNull(rotation)) {
+    Rcpp::NumericMatrix matrix(rotation);
+    if (matrix.nrow() != matrix.ncol() || (!transform->shift.empty() && matrix.nrow() != (int) transform->shift.size())) {
+      Rcpp::stop("Rotation must be a square matrix of the shift length.");
+    }
+    transform->rotation.assign(matrix.begin(), matrix.end());
+  }
+
+  // Done, return:
+  return Rcpp::List::create(Rcpp::_["objective"] = Rcpp::XPtr<deflex_objective>(new deflex_objective(benchmarkTransformed)),
+                            Rcpp::_["data"] = transform);
+}
+
+
+/**
+ * Measures the cost of a native objective function.
+ *
+ * @param objective External pointer to a native `deflex_objective`.
+ * @param data      User data for the native function.
+ * @param points    Points to evaluate, one per row.
+ * @param repeats   Number of times to evaluate each point.
+ * @return Average wall-clock seconds per evaluation.
+ */
+// [[Rcpp::export]]
+double deflex_benchmark_cost (SEXP objective, SEXP data, Rcpp::NumericMatrix points, int repeats) {
+  // Get the objective function:
+  const Objective fn = createObjective(objective, data, false);
+  if (fn.native == NULL) {
+    Rcpp::stop("Objective must be an external pointer to a native function.");
+  }
+
+  // Get points as rows:
+  const int dimension = points.ncol();
+  std::vector<double> rows(points.size());
+  for (int i = 0; i < points.nrow(); i++) {
+    for (int j = 0; j < dimension; j++) {
+      rows[static_cast<size_t>(i) * dimension + j] = points(i, j);
+    }
+  }
+
+  // Evaluate and keep the sum so that evaluations are not optimised away:
+  volatile double sum = 0;
+  const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  for (int r = 0; r < repeats; r++) {
+    for (int i = 0; i < points.nrow(); i++) {
+      sum = sum + fn.native(&rows[static_cast<size_t>(i) * dimension], dimension, fn.data);
+    }
+  }
+  const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+  // Done, return:
+  return elapsed.count() / (static_cast<double>(repeats) * points.nrow());
+}
+
+
+/**
+ * Gives the peak resident set size of the R process.
+ *
+ * @param reset Whether to reset the peak afterwards (Linux only).
+ * @return Peak resident set size in bytes, `NA` if not supported.
+ */
+// [[Rcpp::export]]
+double deflex_peak_memory (bool reset = false) {
+  const double retval = peakMemory(reset);
+  return std::isnan(retval) ? NA_REAL : retval;
+}
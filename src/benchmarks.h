@@ -0,0 +1,68 @@
+#include <string>
+#include <vector>
+#include "deflex.h"
+
+#ifndef deflex_benchmarks_h
+#define deflex_benchmarks_h
+
+/**
+ * Provides the standard benchmark functions as native objective
+ * functions. The global minimum of each is 0, at the origin except for
+ * Rosenbrock (at 1) and Schwefel (at 420.9687).
+ */
+double benchmarkSphere (const double* x, int n, void* data);
+double benchmarkRosenbrock (const double* x, int n, void* data);
+double benchmarkRastrigin (const double* x, int n, void* data);
+double benchmarkAckley (const double* x, int n, void* data);
+double benchmarkGriewank (const double* x, int n, void* data);
+double benchmarkSchwefel (const double* x, int n, void* data);
+
+
+/**
+ * Finds the benchmark function by name.
+ *
+ * @param name One of `"sphere"`, `"rosenbrock"`, `"rastrigin"`,
+ *             `"ackley"`, `"griewank"` or `"schwefel"`.
+ * @return The benchmark function.
+ */
+deflex_objective findBenchmark (const std::string& name);
+
+
+/**
+ * Provides the shift and rotation of a CEC-style benchmark function,
+ * which evaluates the base function at `rotation * (x - shift)`.
+ */
+struct Transform {
+  /**
+   * The base benchmark function.
+   */
+  deflex_objective base;
+
+  /**
+   * The shift, ie. the location of the global minimum (empty if none).
+   */
+  std::vector<double> shift;
+
+  /**
+   * The rotation as a column-major square matrix (empty if none).
+   */
+  std::vector<double> rotation;
+};
+
+
+/**
+ * Evaluates the shifted and/or rotated benchmark function given as the
+ * `Transform` in user data.
+ */
+double benchmarkTransformed (const double* x, int n, void* data);
+
+
+/**
+ * Gives the peak resident set size of the process.
+ *
+ * @param reset Whether to reset the peak afterwards (Linux only).
+ * @return Peak resident set size in bytes, `NaN` if not supported.
+ */
+double peakMemory (bool reset);
+
+#endif
@@ -0,0 +1,117 @@
+#include <cstring>
+#include <algorithm>
+#include "cache.h"
+
+Cache::Cache (int capacity, int dimension)
+  : capacity(capacity), dimension(dimension), keys(static_cast<size_t>(capacity) * dimension), scores(capacity),
+    codes(capacity), referenced(capacity, 0), count(0), hand(0), hitCount(0), missCount(0) {
+  // Get the number of index slots as the power of two at least twice the capacity:
+  int size = 2;
+  while (size < 2 * capacity) {
+    size *= 2;
+  }
+  mask = size - 1;
+  slots.assign(size, -1);
+}
+
+
+uint64_t Cache::hash (const double* key) const {
+  uint64_t code = 0x9e3779b97f4a7c15ULL;
+  for (int i = 0; i < dimension; i++) {
+    // Add zero to make -0 the same as 0:
+    const double value = key[i] + 0.0;
+    uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    code = (code ^ bits) * 0xbf58476d1ce4e5b9ULL;
+    code ^= code >> 31;
+  }
+  return code;
+}
+
+
+int Cache::locate (const double* key, uint64_t code) const {
+  int slot = static_cast<int>(code & mask);
+  while (slots[slot] >= 0) {
+    const int entry = slots[slot];
+    if (codes[entry] == code) {
+      const double* other = &keys[static_cast<size_t>(entry) * dimension];
+      int i = 0;
+      while (i < dimension && key[i] == other[i]) {
+        i++;
+      }
+      if (i == dimension) {
+        return slot;
+      }
+    }
+    slot = (slot + 1) & mask;
+  }
+  return slot;
+}
+
+
+void Cache::remove (int slot) {
+  // Shift the following slots back unless they are at their home slot or beyond:
+  int next = (slot + 1) & mask;
+  while (slots[next] >= 0) {
+    const int home = static_cast<int>(codes[slots[next]] & mask);
+    if (((next - home) & mask) >= ((next - slot) & mask)) {
+      slots[slot] = slots[next];
+      slot = next;
+    }
+    next = (next + 1) & mask;
+  }
+  slots[slot] = -1;
+}
+
+
+bool Cache::find (const double* key, double& score) {
+  const int slot = locate(key, hash(key));
+  if (slots[slot] < 0) {
+    missCount++;
+    return false;
+  }
+  hitCount++;
+  referenced[slots[slot]] = 1;
+  score = scores[slots[slot]];
+  return true;
+}
+
+
+void Cache::insert (const double* key, double score) {
+  // Nothing to do without any capacity:
+  if (capacity == 0) {
+    return;
+  }
+
+  // Check if we have the vector already:
+  const uint64_t code = hash(key);
+  if (slots[locate(key, code)] >= 0) {
+    return;
+  }
+
+  // Get a free entry, or evict the first one which is not referenced since the last sweep:
+  int entry = count;
+  if (count < capacity) {
+    count++;
+  }
+  else {
+    while (referenced[hand]) {
+      referenced[hand] = 0;
+      hand = (hand + 1) % capacity;
+    }
+    entry = hand;
+    hand = (hand + 1) % capacity;
+    int slot = static_cast<int>(codes[entry] & mask);
+    while (slots[slot] != entry) {
+      slot = (slot + 1) & mask;
+    }
+    remove(slot);
+  }
+
+  // Keep the entry and index it:
+  std::copy(key, key + dimension, keys.begin() + static_cast<size_t>(entry) * dimension);
+  scores[entry] = score;
+  codes[entry] = code;
+  referenced[entry] = 0;
+  slots[locate(key, code)] = entry;
+}
@@ -0,0 +1,123 @@
+#include <vector>
+#include <stdint.h>
+
+#ifndef deflex_cache_h
+#define deflex_cache_h
+
+/**
+ * Provides a bounded cache of objective scores keyed on parameter
+ * vectors.
+ *
+ * Entries are kept in a fixed table of `capacity` entries, and are
+ * found through an open-addressing index with linear probing which
+ * has at least twice as many slots. Once full, entries are evicted as
+ * per the CLOCK policy: the hand sweeps over the entries, sparing (and
+ * unmarking) the ones used since its last sweep and evicting the first
+ * one which is not. Nothing is allocated after construction.
+ *
+ * Parameter vectors are compared by value, hence `-0` and `0` are the
+ * same. With precision in use, trials are snapped to a grid and the
+ * same grid point is always the same vector.
+ */
+class Cache {
+public:
+  /**
+   * @param capacity  Maximum number of entries.
+   * @param dimension Number of parameters.
+   */
+  Cache (int capacity, int dimension);
+
+  /**
+   * Looks up the score of a parameter vector.
+   *
+   * @param key   The parameter vector.
+   * @param score The score if found (output).
+   * @return Whether found.
+   */
+  bool find (const double* key, double& score);
+
+  /**
+   * Inserts the score of a parameter vector, evicting an entry if
+   * full. Does nothing if the vector is already in the cache.
+   *
+   * @param key   The parameter vector.
+   * @param score The score.
+   */
+  void insert (const double* key, double score);
+
+  /**
+   * @return Number of lookups which found the score.
+   */
+  double hits () const { return hitCount; }
+
+  /**
+   * @return Number of lookups which did not find the score.
+   */
+  double misses () const { return missCount; }
+
+private:
+  /**
+   * Hashes a parameter vector.
+   */
+  uint64_t hash (const double* key) const;
+
+  /**
+   * Finds the slot of the index which refers to the parameter vector,
+   * or the empty slot to put it to.
+   */
+  int locate (const double* key, uint64_t code) const;
+
+  /**
+   * Removes a slot from the index and shifts the following slots of
+   * the probe sequence back.
+   */
+  void remove (int slot);
+
+  int capacity;
+  int dimension;
+
+  /**
+   * Index slot mask (number of slots minus one).
+   */
+  int mask;
+
+  /**
+   * Entry of each index slot, `-1` if empty.
+   */
+  std::vector<int> slots;
+
+  /**
+   * Parameter vectors of entries, one after another.
+   */
+  std::vector<double> keys;
+
+  /**
+   * Scores of entries.
+   */
+  std::vector<double> scores;
+
+  /**
+   * Hashes of entries.
+   */
+  std::vector<uint64_t> codes;
+
+  /**
+   * Whether the entries were used since the last sweep of the hand.
+   */
+  std::vector<char> referenced;
+
+  /**
+   * Number of entries in use.
+   */
+  int count;
+
+  /**
+   * The CLOCK hand.
+   */
+  int hand;
+
+  double hitCount;
+  double missCount;
+};
+
+#endif
@@ -0,0 +1,305 @@
+#include <cstdio>
+#include <cstring>
+#include <stdint.h>
+#include "checkpoint.h"
+
+void takeSnapshot (Snapshot& snapshot,
+                   int initial,
+                   int generation,
+                   double evaluations,
+                   const State& state,
+                   const std::vector<Random>& streams,
+                   RngKind rngKind,
+                   const Termination& termination) {
+  // Keep the counters:
+  snapshot.dimension = state.population.width();
+  snapshot.popsize = state.population.size();
+  snapshot.initialPopsize = initial;
+  snapshot.generation = generation;
+  snapshot.evaluations = evaluations;
+
+  // Keep the population:
+  snapshot.population.resize(static_cast<size_t>(snapshot.popsize) * snapshot.dimension);
+  state.population.write(snapshot.population.data());
+  snapshot.scores = state.scores;
+  snapshot.bestMember = state.bestMember;
+  snapshot.bestScore = state.bestScore;
+
+  // Keep the adaptation:
+  snapshot.meanCR = state.meanCR;
+  snapshot.meanF = state.meanF;
+  snapshot.goodCR = state.goodCR;
+  snapshot.goodF = state.goodF;
+  snapshot.goodF2 = state.goodF2;
+  snapshot.goodNPCount = state.goodNPCount;
+
+  // Keep the termination criteria:
+  snapshot.lastBestScore = termination.lastBest();
+  snapshot.stagnant = termination.stagnantGenerations();
+
+  // Keep the random number streams:
+  snapshot.streams.resize(streams.size());
+  for (size_t i = 0; i < streams.size(); i++) {
+    snapshot.streams[i].clear();
+    streams[i].saveState(snapshot.streams[i]);
+  }
+
+  // Keep the state of R's random number generator, if in use:
+  snapshot.randomSeed.clear();
+  if (rngKind == RNG_R) {
+    PutRNGstate();
+    Rcpp::Environment globalEnv = Rcpp::Environment::global_env();
+    if (globalEnv.exists(".Random.seed")) {
+      Rcpp::IntegerVector seed(globalEnv.get(".Random.seed"));
+      snapshot.randomSeed.assign(seed.begin(), seed.end());
+    }
+  }
+}
+
+
+void restoreSnapshot (const Snapshot& snapshot,
+                      State& state,
+                      std::vector<Random>& streams,
+                      RngKind rngKind,
+                      Termination& termination) {
+  // Check the problem:
+  if (snapshot.popsize != state.population.size() || snapshot.dimension != state.population.width()) {
+    Rcpp::stop("Checkpoint does not match the population size and the problem dimension.");
+  }
+  if (snapshot.streams.size() != streams.size()) {
+    Rcpp::stop("Checkpoint was written with a different number of threads.");
+  }
+  if ((rngKind == RNG_R) != !snapshot.randomSeed.empty()) {
+    Rcpp::stop("Checkpoint was written with a different random number generator.");
+  }
+
+  // Restore the random number streams:
+  for (size_t i = 0; i < streams.size(); i++) {
+    if (!streams[i].loadState(snapshot.streams[i].data(), snapshot.streams[i].size())) {
+      Rcpp::stop("Checkpoint was written with a different random number generator.");
+    }
+  }
+
+  // Restore the state of R's random number generator, if in use:
+  if (rngKind == RNG_R) {
+    Rcpp::IntegerVector seed(snapshot.randomSeed.begin(), snapshot.randomSeed.end());
+    Rcpp::Environment::global_env().assign(".Random.seed", seed);
+    GetRNGstate();
+  }
+
+  // Restore the population:
+  state.population.read(snapshot.population.data());
+  state.scores = snapshot.scores;
+  state.bestMember = snapshot.bestMember;
+  state.bestScore = snapshot.bestScore;
+
+  // Restore the adaptation:
+  state.meanCR = snapshot.meanCR;
+  state.meanF = snapshot.meanF;
+  state.goodCR = snapshot.goodCR;
+  state.goodF = snapshot.goodF;
+  state.goodF2 = snapshot.goodF2;
+  state.goodNPCount = snapshot.goodNPCount;
+
+  // Restore the termination criteria:
+  termination.resume(snapshot.lastBestScore, snapshot.stagnant);
+}
+
+
+/**
+ * Writes the snapshot to a file.
+ *
+ * @return Whether the snapshot is written.
+ */
+static bool writeSnapshot (const Snapshot& snapshot, std::FILE* file) {
+  // Write the header:
+  char header[64] = { 'D', 'E', 'F', 'L', 'E', 'X', 'C', 0 };
+  const int32_t fields[6] = { 1, snapshot.dimension, snapshot.popsize, static_cast<int32_t>(snapshot.streams.size()), static_cast<int32_t>(snapshot.randomSeed.size()), snapshot.initialPopsize };
+  std::memcpy(header + 8, fields, sizeof(fields));
+  bool ok = std::fwrite(header, 1, sizeof(header), file) == sizeof(header);
+
+  // Write the counters, best member, scores and the population:
+  const double counters[11] = {
+    static_cast<double>(snapshot.generation), snapshot.evaluations, snapshot.bestScore,
+    snapshot.meanCR, snapshot.meanF, snapshot.goodCR, snapshot.goodF, snapshot.goodF2, static_cast<double>(snapshot.goodNPCount),
+    snapshot.lastBestScore, static_cast<double>(snapshot.stagnant)
+  };
+  ok = ok && std::fwrite(counters, sizeof(double), 11, file) == 11;
+  ok = ok && std::fwrite(snapshot.bestMember.data(), sizeof(double), snapshot.bestMember.size(), file) == snapshot.bestMember.size();
+  ok = ok && std::fwrite(snapshot.scores.data(), sizeof(double), snapshot.scores.size(), file) == snapshot.scores.size();
+  ok = ok && std::fwrite(snapshot.population.data(), sizeof(double), snapshot.population.size(), file) == snapshot.population.size();
+
+  // Write the random number streams:
+  for (size_t i = 0; i < snapshot.streams.size(); i++) {
+    const int64_t size = snapshot.streams[i].size();
+    ok = ok && std::fwrite(&size, sizeof(size), 1, file) == 1;
+    ok = ok && std::fwrite(snapshot.streams[i].data(), 1, size, file) == static_cast<size_t>(size);
+  }
+  ok = ok && std::fwrite(snapshot.randomSeed.data(), sizeof(int), snapshot.randomSeed.size(), file) == snapshot.randomSeed.size();
+  return ok;
+}
+
+
+Snapshot readCheckpoint (const std::string& path) {
+  // Open the file:
+  std::FILE* file = std::fopen(path.c_str(), "rb");
+  if (file == NULL) {
+    Rcpp::stop("Can not open checkpoint file for reading: " + path);
+  }
+
+  // Read the header:
+  Snapshot snapshot;
+  char header[64];
+  int32_t fields[6];
+  bool ok = std::fread(header, 1, sizeof(header), file) == sizeof(header) && std::memcmp(header, "DEFLEXC", 8) == 0;
+  std::memcpy(fields, header + 8, sizeof(fields));
+  ok = ok && fields[0] == 1 && fields[1] > 0 && fields[2] > 0 && fields[3] > 0 && fields[4] >= 0 && fields[5] >= 0;
+
+  // Read the counters, best member, scores and the population:
+  double counters[11];
+  if (ok) {
+    snapshot.dimension = fields[1];
+    snapshot.popsize = fields[2];
+    snapshot.initialPopsize = fields[5] == 0 ? fields[2] : fields[5];
+    snapshot.bestMember.resize(snapshot.dimension);
+    snapshot.scores.resize(snapshot.popsize);
+    snapshot.population.resize(static_cast<size_t>(snapshot.popsize) * snapshot.dimension);
+    snapshot.streams.resize(fields[3]);
+    snapshot.randomSeed.resize(fields[4]);
+    ok = std::fread(counters, sizeof(double), 11, file) == 11 &&
+      std::fread(snapshot.bestMember.data(), sizeof(double), snapshot.bestMember.size(), file) == snapshot.bestMember.size() &&
+      std::fread(snapshot.scores.data(), sizeof(double), snapshot.scores.size(), file) == snapshot.scores.size() &&
+      std::fread(snapshot.population.data(), sizeof(double), snapshot.population.size(), file) == snapshot.population.size();
+  }
+
+  // Read the random number streams:
+  for (size_t i = 0; ok && i < snapshot.streams.size(); i++) {
+    int64_t size = 0;
+    ok = std::fread(&size, sizeof(size), 1, file) == 1 && size >= 0 && size < (1 << 30);
+    if (ok) {
+      snapshot.streams[i].resize(size);
+      ok = std::fread(snapshot.streams[i].data(), 1, size, file) == static_cast<size_t>(size);
+    }
+  }
+  ok = ok && std::fread(snapshot.randomSeed.data(), sizeof(int), snapshot.randomSeed.size(), file) == snapshot.randomSeed.size();
+  std::fclose(file);
+  if (!ok) {
+    Rcpp::stop("Invalid checkpoint file: " + path);
+  }
+
+  // Done, return:
+  snapshot.generation = static_cast<int>(counters[0]);
+  snapshot.evaluations = counters[1];
+  snapshot.bestScore = counters[2];
+  snapshot.meanCR = counters[3];
+  snapshot.meanF = counters[4];
+  snapshot.goodCR = counters[5];
+  snapshot.goodF = counters[6];
+  snapshot.goodF2 = counters[7];
+  snapshot.goodNPCount = static_cast<int>(counters[8]);
+  snapshot.lastBestScore = counters[9];
+  snapshot.stagnant = static_cast<int>(counters[10]);
+  return snapshot;
+}
+
+
+Checkpoint::Checkpoint (const std::string& path) : path(path), hasPending(false), busy(false), stopping(false) {
+  thread = std::thread(&Checkpoint::run, this);
+}
+
+
+Checkpoint::~Checkpoint () {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stopping = true;
+  }
+  condition.notify_all();
+  if (thread.joinable()) {
+    thread.join();
+  }
+}
+
+
+void Checkpoint::submit () {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::swap(front, pending);
+    hasPending = true;
+  }
+  condition.notify_all();
+  raise();
+}
+
+
+void Checkpoint::close () {
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    condition.wait(lock, [this] { return !hasPending && !busy; });
+    stopping = true;
+  }
+  condition.notify_all();
+  thread.join();
+  raise();
+}
+
+
+void Checkpoint::raise () {
+  std::string message;
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    message.swap(error);
+  }
+  if (!message.empty()) {
+    Rcpp::stop(message);
+  }
+}
+
+
+void Checkpoint::run () {
+  const std::string temporary = path + ".tmp";
+  while (true) {
+    // Wait for the next snapshot:
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      condition.wait(lock, [this] { return hasPending || stopping; });
+      if (!hasPending) {
+        return;
+      }
+      std::swap(pending, writing);
+      hasPending = false;
+      busy = true;
+    }
+
+    // Write to the temporary file and replace the checkpoint file with it:
+    std::string message;
+    std::FILE* file = std::fopen(temporary.c_str(), "wb");
+    if (file == NULL) {
+      message = "Can not open checkpoint file for writing: " + temporary;
+    }
+    else {
+      const bool written = writeSnapshot(writing, file);
+      if (std::fclose(file) != 0 || !written) {
+        message = "Can not write to the checkpoint file: " + temporary;
+      }
+      else {
+#ifdef _WIN32
+        // Renaming does not replace existing files on Windows:
+        std::remove(path.c_str());
+#endif
+        if (std::rename(temporary.c_str(), path.c_str()) != 0) {
+          message = "Can not replace the checkpoint file: " + path;
+        }
+      }
+    }
+
+    // Done with the snapshot:
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      busy = false;
+      if (!message.empty()) {
+        error = message;
+      }
+    }
+    condition.notify_all();
+  }
+}
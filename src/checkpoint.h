@@ -0,0 +1,230 @@
+#include <string>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <Rcpp.h>
+#include "rng.h"
+#include "engine.h"
+#include "termination.h"
+
+#ifndef deflex_checkpoint_h
+#define deflex_checkpoint_h
+
+/**
+ * Provides the complete state of the evolution after a generation,
+ * enough to resume it with the same results as an uninterrupted run.
+ */
+struct Snapshot {
+  /**
+   * Problem dimension.
+   */
+  int dimension;
+
+  /**
+   * Population size.
+   */
+  int popsize;
+
+  /**
+   * Initial population size, which differs from the population size if
+   * the population shrinks (see `Reduction`).
+   */
+  int initialPopsize;
+
+  /**
+   * The generation completed.
+   */
+  int generation;
+
+  /**
+   * Number of evaluations so far.
+   */
+  double evaluations;
+
+  /**
+   * The population in R's column-major matrix layout.
+   */
+  std::vector<double> population;
+
+  /**
+   * The population scores.
+   */
+  std::vector<double> scores;
+
+  /**
+   * The best member.
+   */
+  std::vector<double> bestMember;
+
+  /**
+   * The best score.
+   */
+  double bestScore;
+
+  /**
+   * Mean crossover probability and differential weighting factor, and
+   * their accumulators (see `State`).
+   */
+  double meanCR;
+  double meanF;
+  double goodCR;
+  double goodF;
+  double goodF2;
+  int goodNPCount;
+
+  /**
+   * Best score as of the last termination check, and the number of
+   * generations without improvement (see `Termination`).
+   */
+  double lastBestScore;
+  int stagnant;
+
+  /**
+   * The state of each random number stream (see `Random::saveState`).
+   */
+  std::vector<std::vector<char> > streams;
+
+  /**
+   * R's `.Random.seed`, if R's random number generator is in use.
+   */
+  std::vector<int> randomSeed;
+};
+
+
+/**
+ * Takes the snapshot of the evolution.
+ *
+ * It reuses the storage of the snapshot, and must be called from the
+ * main thread as it reads the state of R's random number generator.
+ *
+ * @param snapshot    The snapshot to fill.
+ * @param initial     Initial population size.
+ * @param generation  The generation completed.
+ * @param evaluations Number of evaluations so far.
+ * @param state       The state of the evolution.
+ * @param streams     The random number streams.
+ * @param rngKind     The random number generator kind.
+ * @param termination The termination criteria.
+ */
+void takeSnapshot (Snapshot& snapshot,
+                   int initial,
+                   int generation,
+                   double evaluations,
+                   const State& state,
+                   const std::vector<Random>& streams,
+                   RngKind rngKind,
+                   const Termination& termination);
+
+
+/**
+ * Restores the evolution from the snapshot.
+ *
+ * It must be called from the main thread as it sets the state of R's
+ * random number generator.
+ *
+ * @param snapshot    The snapshot.
+ * @param state       The state of the evolution of the same population size and dimension.
+ * @param streams     The random number streams of the same kind and number.
+ * @param rngKind     The random number generator kind.
+ * @param termination The termination criteria.
+ */
+void restoreSnapshot (const Snapshot& snapshot,
+                      State& state,
+                      std::vector<Random>& streams,
+                      RngKind rngKind,
+                      Termination& termination);
+
+
+/**
+ * Reads the snapshot from a checkpoint file.
+ *
+ * @param path Path to the checkpoint file.
+ * @return The snapshot.
+ */
+Snapshot readCheckpoint (const std::string& path);
+
+
+/**
+ * Writes snapshots to a checkpoint file in the background.
+ *
+ * Snapshots are double-buffered: the main thread fills the spare
+ * snapshot and hands it over, while the background thread writes the
+ * last one handed over. If the writer falls behind, only the latest
+ * snapshot is written. Each snapshot is written to a temporary file
+ * which then replaces the checkpoint file, so that the checkpoint file
+ * is complete at all times.
+ *
+ * The checkpoint file starts with a header of 64 bytes:
+ *
+ * - magic `DEFLEXC` followed by a zero byte (8 bytes),
+ * - format version (int32),
+ * - problem dimension D (int32),
+ * - population size NP (int32),
+ * - number of random number streams S (int32),
+ * - length of R's `.Random.seed` L (int32, 0 if not in use),
+ * - initial population size (int32, NP unless the population shrinks),
+ * - zero padding up to 64 bytes.
+ *
+ * It is followed by `11 + D + NP + NP * D` doubles: generation,
+ * evaluations, best score, meanCR, meanF, goodCR, goodF, goodF2,
+ * goodNPCount, last best score and stagnant generations, best member,
+ * population scores and population in R's column-major matrix layout.
+ * Then, each stream state as its size in bytes (int64) and the bytes,
+ * and finally L int32s of R's `.Random.seed`. Numbers are written in
+ * the native byte order.
+ */
+class Checkpoint {
+public:
+  /**
+   * Starts the background thread.
+   *
+   * @param path Path to the checkpoint file.
+   */
+  explicit Checkpoint (const std::string& path);
+
+  /**
+   * Stops and joins the background thread, without throwing.
+   */
+  ~Checkpoint ();
+
+  /**
+   * @return The spare snapshot to fill before `submit`.
+   */
+  Snapshot& spare () {
+    return front;
+  }
+
+  /**
+   * Hands the spare snapshot over to the background thread.
+   *
+   * It re-throws the error of a previous write, if any.
+   */
+  void submit ();
+
+  /**
+   * Waits until the last snapshot handed over is written and stops the
+   * background thread.
+   *
+   * It re-throws the error of a previous write, if any.
+   */
+  void close ();
+
+private:
+  void run ();
+  void raise ();
+
+  std::string path;
+  Snapshot front;
+  Snapshot pending;
+  Snapshot writing;
+  bool hasPending;
+  bool busy;
+  bool stopping;
+  std::string error;
+  std::mutex mutex;
+  std::condition_variable condition;
+  std::thread thread;
+};
+
+#endif
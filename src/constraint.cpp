@@ -0,0 +1,93 @@
+#include <cmath>
+#include <stdexcept>
+#include "constraint.h"
+
+ConstraintHandling parseConstraintHandling (const std::string& name) {
+  if (name == "deb") {
+    return CONSTRAINT_DEB;
+  }
+  else if (name == "penalty") {
+    return CONSTRAINT_PENALTY;
+  }
+  Rcpp::stop("Unknown constraint handling: " + name);
+}
+
+
+Constraint createConstraint (SEXP constraint, SEXP data, ConstraintHandling handling, double penalty, double tolerance) {
+  // Declare the return value:
+  Constraint retval;
+  retval.function.function = R_NilValue;
+  retval.function.native = NULL;
+  retval.function.data = NULL;
+  retval.function.batch = true;
+  retval.function.tolerance = tolerance;
+  retval.handling = handling;
+  retval.penalty = penalty;
+  retval.tolerance = tolerance;
+
+  // Get the constraint function, if any:
+  if (!Rf_isNull(constraint)) {
+    if (!Rf_isFunction(constraint) && TYPEOF(constraint) != EXTPTRSXP) {
+      Rcpp::stop("Constraint must be an R function or an external pointer to a native function.");
+    }
+    retval.function = createObjective(constraint, data, true, tolerance);
+  }
+
+  // Done, return:
+  return retval;
+}
+
+
+double constraintViolation (const Constraint& constraint, const double* candidate, int dimension) {
+  const double violation = constraint.function.native(candidate, dimension, constraint.function.data);
+  if (std::isnan(violation)) {
+    throw std::runtime_error("NaN value of constraint function!");
+  }
+  return violation;
+}
+
+
+int screenCandidates (const Constraint& constraint,
+                      const Population& candidates,
+                      std::vector<double>& scores,
+                      std::vector<double>& ranks,
+                      std::vector<char>& screened) {
+  // Get the number of candidates and the problem dimension:
+  const int count = candidates.size();
+  const int dimension = candidates.width();
+  std::vector<double> violations(count);
+
+  // Compute the violations, either one by one or in one call:
+  if (constraint.function.native != NULL) {
+    std::vector<double> buffer(dimension);
+    for (int i = 0; i < count; i++) {
+      violations[i] = constraintViolation(constraint, candidates.row(i, buffer.data()), dimension);
+    }
+  }
+  else {
+    Rcpp::NumericMatrix matrix(count, dimension);
+    candidates.write(matrix.begin());
+    Rcpp::Shield<SEXP> call(Rf_lang2(constraint.function.function, matrix));
+    Rcpp::NumericVector result(Rcpp::Rcpp_eval(call, R_GlobalEnv));
+    if (result.size() != count) {
+      Rcpp::stop("Constraint function must return one violation per row.");
+    }
+    for (int i = 0; i < count; i++) {
+      if (ISNAN(result[i])) {
+        Rcpp::stop("NaN value of constraint function!");
+      }
+      violations[i] = result[i];
+    }
+  }
+
+  // Resolve infeasible candidates:
+  int infeasible = 0;
+  screened.resize(count);
+  for (int i = 0; i < count; i++) {
+    screened[i] = constraint.resolve(violations[i], scores[i], ranks[i]);
+    infeasible += screened[i];
+  }
+
+  // Done, return:
+  return infeasible;
+}
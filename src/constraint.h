@@ -0,0 +1,152 @@
+#include <string>
+#include <vector>
+#include <Rcpp.h>
+#include "evaluate.h"
+#include "population.h"
+
+#ifndef deflex_constraint_h
+#define deflex_constraint_h
+
+/**
+ * Enumerates the ways to resolve infeasible candidates.
+ */
+enum ConstraintHandling {
+  /**
+   * Deb's feasibility rules: a feasible candidate beats an infeasible
+   * one, feasible candidates compare by their scores, and infeasible
+   * ones by their constraint violations. Infeasible candidates score
+   * `Inf`.
+   */
+  CONSTRAINT_DEB,
+
+  /**
+   * Static penalty: infeasible candidates score the penalty factor
+   * times their constraint violation, and compare with feasible ones
+   * by their scores.
+   */
+  CONSTRAINT_PENALTY
+};
+
+
+/**
+ * Parses the constraint handling.
+ *
+ * @param name One of `"deb"` or `"penalty"`.
+ * @return The constraint handling.
+ */
+ConstraintHandling parseConstraintHandling (const std::string& name);
+
+
+/**
+ * Provides the constraint function which screens candidates before
+ * the objective function.
+ *
+ * The constraint function gives the total constraint violation of a
+ * candidate, and candidates of which the violation is not more than
+ * the tolerance are feasible. Native constraint functions have the
+ * signature of native objective functions (see `deflex_objective`)
+ * and are called for each candidate. R constraint functions are
+ * vectorised: they are called once with the matrix of candidates (one
+ * candidate per row) and return a vector of violations.
+ */
+struct Constraint {
+  /**
+   * The constraint function (inactive if neither is set).
+   */
+  Objective function;
+
+  /**
+   * How infeasible candidates are resolved.
+   */
+  ConstraintHandling handling;
+
+  /**
+   * Penalty factor of `CONSTRAINT_PENALTY`.
+   */
+  double penalty;
+
+  /**
+   * Largest violation of feasible candidates.
+   */
+  double tolerance;
+
+  /**
+   * @return Whether a constraint function is given.
+   */
+  bool active () const {
+    return function.native != NULL || !Rf_isNull(function.function);
+  }
+
+  /**
+   * Resolves the violation of a candidate.
+   *
+   * @param violation The constraint violation of the candidate.
+   * @param score     The candidate score, set if the candidate is infeasible (output).
+   * @param rank      The violation to compare candidates by, 0 if feasible (output).
+   * @return Whether the candidate is infeasible, ie. screened out.
+   */
+  bool resolve (double violation, double& score, double& rank) const {
+    if (violation <= tolerance) {
+      rank = 0;
+      return false;
+    }
+    if (handling == CONSTRAINT_DEB) {
+      score = R_PosInf;
+      rank = violation;
+    }
+    else {
+      score = penalty * violation;
+      rank = 0;
+    }
+    return true;
+  }
+};
+
+
+/**
+ * Creates the constraint.
+ *
+ * @param constraint R function, external pointer to a native function or `NULL` for none.
+ * @param data       User data for the native function.
+ * @param handling   How infeasible candidates are resolved.
+ * @param penalty    Penalty factor.
+ * @param tolerance  Largest violation of feasible candidates.
+ * @return The constraint.
+ */
+Constraint createConstraint (SEXP constraint, SEXP data, ConstraintHandling handling, double penalty, double tolerance);
+
+
+/**
+ * Calls the native constraint function on a candidate without touching
+ * R objects.
+ *
+ * @param constraint The constraint with a native function.
+ * @param candidate  The candidate.
+ * @param dimension  Problem dimension.
+ * @return The constraint violation.
+ */
+double constraintViolation (const Constraint& constraint, const double* candidate, int dimension);
+
+
+/**
+ * Screens candidates with the constraint function.
+ *
+ * Infeasible candidates get their scores and violations to compare by
+ * (see `Constraint::resolve`) and are flagged, so that the objective
+ * function is not called for them. Feasible candidates get 0
+ * violations and keep their scores.
+ *
+ * @param constraint The active constraint.
+ * @param candidates The candidates.
+ * @param scores     The candidate scores (output).
+ * @param ranks      The violations to compare candidates by (output).
+ * @param screened   Flags of infeasible candidates (output).
+ * @return Number of infeasible candidates.
+ */
+int screenCandidates (const Constraint& constraint,
+                      const Population& candidates,
+                      std::vector<double>& scores,
+                      std::vector<double>& ranks,
+                      std::vector<char>& screened);
+
+#endif
@@ -0,0 +1,399 @@
+#include <string>
+#include <vector>
+#include <Rcpp.h>
+
+#ifndef deflex_control_h
+#define deflex_control_h
+
+/**
+ * Provides optional settings of the DE routine.
+ *
+ * Settings are read from the `control` list given to the DE routine.
+ * Missing entries fall back to the defaults documented below.
+ */
+struct Control {
+  /**
+   * Whether the objective function is called once per generation
+   * with the matrix of all trials (one trial per row) and returns a
+   * vector of scores, instead of once per trial (default: `FALSE`).
+   */
+  bool batch;
+
+  /**
+   * User data passed to native objective functions (default: `NULL`).
+   */
+  SEXP data;
+
+  /**
+   * Number of threads to build and evaluate trials on (default: `1`).
+   * More than one thread requires a thread-safe native objective
+   * function.
+   */
+  int threads;
+
+  /**
+   * Number of forked R worker processes to evaluate trials of an R
+   * objective function on (default: `0`, ie. evaluate in the session).
+   * Scores do not depend on the number of workers. Not available on
+   * Windows.
+   */
+  int processes;
+
+  /**
+   * Random number generator (default: `"R"`): `"R"` uses R's random
+   * number generator, `"xoshiro"` and `"pcg"` use the internal
+   * xoshiro256++ and PCG64 engines which generate random numbers in
+   * bulk. Multi-threaded runs always use an internal engine, and
+   * `"xoshiro"` if `"R"` is given.
+   */
+  std::string rng;
+
+  /**
+   * Seed of the internal random number generator, a non-negative
+   * integer (default: `NA`, ie. drawn from R's random number
+   * generator). Results are reproducible for a given seed and number
+   * of threads.
+   */
+  double seed;
+
+  /**
+   * History retention policy (default: `"all"`): `"all"` keeps every
+   * generation, `"final"` only the final one, `"every"` the initial,
+   * every `historyEvery`-th and the final one, `"best"` the best member
+   * and score of every generation but the population and scores of
+   * the final one, and `"last"` the last `historySize` generations.
+   */
+  std::string history;
+
+  /**
+   * Interval of generations to keep for the `"every"` history
+   * retention policy (default: `1`).
+   */
+  int historyEvery;
+
+  /**
+   * Number of generations to keep for the `"last"` history retention
+   * policy (default: `1`).
+   */
+  int historySize;
+
+  /**
+   * Path to the binary file to stream every generation to (default:
+   * `""`, ie. disabled). See `HistoryFile` for the format and
+   * `read_history` for the reader.
+   */
+  std::string historyFile;
+
+  /**
+   * Storage layout of the population (default: `"rows"`): `"rows"`
+   * stores each member in a contiguous row, `"columns"` stores each
+   * parameter in a contiguous column.
+   */
+  std::string layout;
+
+  /**
+   * Whether to build trials with SIMD (AVX2 or AVX-512) kernels if
+   * the CPU supports them (default: `TRUE`). Results are the same
+   * either way.
+   */
+  bool simd;
+
+  /**
+   * Target score to stop at once the best score reaches it (default:
+   * `-Inf`, ie. disabled).
+   */
+  double target;
+
+  /**
+   * Number of generations without improvement in the best score to
+   * stop after (default: `0`, ie. disabled).
+   */
+  int stagnation;
+
+  /**
+   * Tolerance to stop at once the difference between the worst and the
+   * best population scores falls below it (default: `0`, ie. disabled).
+   */
+  double scoreTolerance;
+
+  /**
+   * Tolerance to stop at once the difference between the largest and
+   * the smallest value of each parameter over the population falls
+   * below it (default: `0`, ie. disabled).
+   */
+  double parameterTolerance;
+
+  /**
+   * Maximum number of objective function evaluations, including the
+   * initial population, which no generation is started to exceed
+   * (default: `Inf`).
+   */
+  double maxEvaluations;
+
+  /**
+   * Wall-clock time limit in seconds, checked after each generation
+   * (default: `Inf`).
+   */
+  double timeLimit;
+
+  /**
+   * Maximum number of objective scores to keep in the cache, which is
+   * consulted before evaluating a candidate (default: `0`, ie.
+   * disabled). It pays off for expensive objective functions when
+   * precision is in use, as trials often land on grid points evaluated
+   * before. The objective function must be deterministic.
+   */
+  int cache;
+
+  /**
+   * Number of generations between migrations of the island model
+   * (default: `10`).
+   */
+  int migrationInterval;
+
+  /**
+   * Number of best members each island sends at each migration of the
+   * island model (default: `1`).
+   */
+  int migrants;
+
+  /**
+   * Migration topology of the island model (default: `"ring"`):
+   * `"ring"` sends migrants to the next island, `"random"` to another
+   * island picked randomly at each migration.
+   */
+  std::string topology;
+
+  /**
+   * Maximum number of trials in the evaluation pipeline of the
+   * asynchronous mode (default: `0`, ie. twice the number of threads).
+   * It is capped at the population size as a candidate has one trial
+   * in the pipeline at most.
+   */
+  int queueSize;
+
+  /**
+   * Indicates whether to time the phases of each generation and count
+   * events, reported as the `stats` element of the result (default:
+   * `false`). Without it, the instrumentation compiles away.
+   */
+  bool stats;
+
+  /**
+   * Path to the checkpoint file to write the complete state of the
+   * evolution to (default: `""`, ie. no checkpoints).
+   */
+  std::string checkpoint;
+
+  /**
+   * Number of generations between checkpoints (default: `100`).
+   */
+  int checkpointEvery;
+
+  /**
+   * Mutation scheme (default: `"best/1"`): `"best/1"`, `"rand/1"`,
+   * `"current-to-best/1"` or `"rand/2"`.
+   */
+  std::string mutation;
+
+  /**
+   * Crossover scheme (default: `"exponential"`): `"exponential"` or
+   * `"binomial"`.
+   */
+  std::string crossover;
+
+  /**
+   * Boundary handling scheme (default: `""`, ie. `"bounce"` or
+   * `"clamp"` as per the `bounceBack` argument): `"clamp"`,
+   * `"bounce"`, `"reflect"` or `"midpoint"`.
+   */
+  std::string boundary;
+
+  /**
+   * Population size reduction (default: `"none"`): `"none"` keeps the
+   * population size fixed, `"linear"` shrinks it linearly from the
+   * initial size to `minPopsize` over `maxEvaluations` (or over the
+   * iterations if not limited), and `"schedule"` shrinks it as per
+   * `popsizes`. The worst members are dropped.
+   */
+  std::string reduction;
+
+  /**
+   * Minimum population size of the `"linear"` population size
+   * reduction (default: `0`, ie. `4` or the smallest size the mutation
+   * scheme works with, whichever is larger).
+   */
+  int minPopsize;
+
+  /**
+   * Population sizes after generations `1, 2, ...` for the
+   * `"schedule"` population size reduction, the last one holding
+   * afterwards (default: empty).
+   */
+  std::vector<int> popsizes;
+
+  /**
+   * Constraint function to screen candidates with before the objective
+   * function (default: `NULL`, ie. none): an external pointer to a
+   * native function with the signature of native objective functions
+   * called for each candidate, or a vectorised R function called with
+   * the matrix of candidates (one per row). Either gives the total
+   * constraint violation of each candidate, which is 0 for feasible
+   * ones. Native constraint functions get the same `data` as the
+   * objective function.
+   */
+  SEXP constraint;
+
+  /**
+   * How infeasible candidates are resolved without calling the
+   * objective function (default: `"deb"`): `"deb"` applies Deb's
+   * feasibility rules, `"penalty"` scores them `penalty` times their
+   * constraint violation (see `ConstraintHandling`).
+   */
+  std::string constraintHandling;
+
+  /**
+   * Penalty factor of the `"penalty"` constraint handling (default:
+   * `1e6`).
+   */
+  double penalty;
+
+  /**
+   * Tolerance of the bounds check of initial candidates and of the
+   * constraint violations of feasible candidates (default: `1e-8`).
+   */
+  double feasibilityTolerance;
+
+  /**
+   * Surrogate model to skip trials predicted not to improve on their
+   * candidates with (default: `"none"`): `"knn"` predicts scores from
+   * the nearest evaluated points (see `Surrogate`). It requires
+   * single-threaded evaluation.
+   */
+  std::string surrogate;
+
+  /**
+   * Number of nearest points the surrogate predicts from (default:
+   * `5`).
+   */
+  int surrogateNeighbours;
+
+  /**
+   * Maximum number of evaluated points the surrogate keeps, the most
+   * recent ones (default: `1000`).
+   */
+  int surrogateCapacity;
+
+  /**
+   * Fraction of the trials predicted not to improve which are evaluated
+   * nevertheless, the farthest from evaluated points first (default:
+   * `0.1`).
+   */
+  double surrogateExploration;
+
+  /**
+   * Incremental objective function to evaluate trials from their
+   * candidates with, as an external pointer to a `deflex_delta`
+   * (default: `NULL`). It replaces the objective function but for the
+   * initial population, and gets the same `data`.
+   */
+  SEXP delta;
+
+  /**
+   * Whether trials are snapped to the lattice of the multiples of the
+   * precision within bounds instead of being rounded (default: `FALSE`,
+   * see `Lattice`), as a rounding mode only. The initial population is
+   * snapped, too.
+   */
+  bool lattice;
+};
+
+
+/**
+ * Reads an element from the control list or falls back to a default.
+ *
+ * @param control The control list.
+ * @param name    Name of the element.
+ * @param value   The default value.
+ * @return The element value if present, the default value otherwise.
+ */
+template <typename T>
+inline T controlValue (const Rcpp::List control, const char* name, T value) {
+  if (control.size() == 0 || !control.containsElementNamed(name)) {
+    return value;
+  }
+  return Rcpp::as<T>(control[name]);
+}
+
+
+/**
+ * Stops if any of the given settings is in the control list, for
+ * settings which a mode of the DE routine does not support.
+ *
+ * @param control The control list.
+ * @param names   Names of the unsupported settings.
+ * @param mode    The mode, for example `"the island model"`.
+ */
+inline void rejectControl (const Rcpp::List control, const std::vector<std::string>& names, const std::string& mode) {
+  for (size_t k = 0; k < names.size(); k++) {
+    if (control.size() > 0 && control.containsElementNamed(names[k].c_str())) {
+      Rcpp::stop("Setting `" + names[k] + "` is not supported by " + mode + ".");
+    }
+  }
+}
+
+
+/**
+ * Parses the control list.
+ *
+ * @param control The control list.
+ * @return Parsed settings.
+ */
+inline Control parseControl (const Rcpp::List control) {
+  Control retval;
+  retval.batch = controlValue<bool>(control, "batch", false);
+  retval.data = controlValue<SEXP>(control, "data", R_NilValue);
+  retval.threads = controlValue<int>(control, "threads", 1);
+  retval.processes = controlValue<int>(control, "processes", 0);
+  retval.rng = controlValue<std::string>(control, "rng", "R");
+  retval.seed = controlValue<double>(control, "seed", NA_REAL);
+  retval.history = controlValue<std::string>(control, "history", "all");
+  retval.historyEvery = controlValue<int>(control, "historyEvery", 1);
+  retval.historySize = controlValue<int>(control, "historySize", 1);
+  retval.historyFile = controlValue<std::string>(control, "historyFile", "");
+  retval.layout = controlValue<std::string>(control, "layout", "rows");
+  retval.simd = controlValue<bool>(control, "simd", true);
+  retval.target = controlValue<double>(control, "target", R_NegInf);
+  retval.stagnation = controlValue<int>(control, "stagnation", 0);
+  retval.scoreTolerance = controlValue<double>(control, "scoreTolerance", 0);
+  retval.parameterTolerance = controlValue<double>(control, "parameterTolerance", 0);
+  retval.maxEvaluations = controlValue<double>(control, "maxEvaluations", R_PosInf);
+  retval.timeLimit = controlValue<double>(control, "timeLimit", R_PosInf);
+  retval.cache = controlValue<int>(control, "cache", 0);
+  retval.migrationInterval = controlValue<int>(control, "migrationInterval", 10);
+  retval.migrants = controlValue<int>(control, "migrants", 1);
+  retval.topology = controlValue<std::string>(control, "topology", "ring");
+  retval.queueSize = controlValue<int>(control, "queueSize", 0);
+  retval.stats = controlValue<bool>(control, "stats", false);
+  retval.checkpoint = controlValue<std::string>(control, "checkpoint", "");
+  retval.checkpointEvery = controlValue<int>(control, "checkpointEvery", 100);
+  retval.mutation = controlValue<std::string>(control, "mutation", "best/1");
+  retval.crossover = controlValue<std::string>(control, "crossover", "exponential");
+  retval.boundary = controlValue<std::string>(control, "boundary", "");
+  retval.reduction = controlValue<std::string>(control, "reduction", "none");
+  retval.minPopsize = controlValue<int>(control, "minPopsize", 0);
+  retval.popsizes = controlValue<std::vector<int> >(control, "popsizes", std::vector<int>());
+  retval.constraint = controlValue<SEXP>(control, "constraint", R_NilValue);
+  retval.constraintHandling = controlValue<std::string>(control, "constraintHandling", "deb");
+  retval.penalty = controlValue<double>(control, "penalty", 1e6);
+  retval.feasibilityTolerance = controlValue<double>(control, "feasibilityTolerance", 1e-8);
+  retval.surrogate = controlValue<std::string>(control, "surrogate", "none");
+  retval.surrogateNeighbours = controlValue<int>(control, "surrogateNeighbours", 5);
+  retval.surrogateCapacity = controlValue<int>(control, "surrogateCapacity", 1000);
+  retval.surrogateExploration = controlValue<double>(control, "surrogateExploration", 0.1);
+  retval.delta = controlValue<SEXP>(control, "delta", R_NilValue);
+  retval.lattice = controlValue<bool>(control, "lattice", false);
+  return retval;
+}
+
+#endif
@@ -1,55 +1,418 @@
+#include <cmath>
 #include <vector>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <algorithm>
 #include <Rcpp.h>
 #include "utils.h"
+#include "control.h"
 #include "evaluate.h"
+#include "engine.h"
+#include "threadpool.h"
+#include "history.h"
+#include "kernels.h"
+#include "termination.h"
+#include "cache.h"
+#include "islands.h"
+#include "pipeline.h"
+#include "stats.h"
+#include "checkpoint.h"
+#include "reduction.h"
+#include "batch.h"
+#include "constraint.h"
+#include "surrogate.h"
+#include "delta.h"
+#include "sampling.h"
 
+/**
+ * Provides the DE routine, instrumented with the given probe (see `Stats`
+ * and `NoStats`), optionally resuming from a snapshot.
+ */
+template <typename Probe>
+static SEXP strategy3 (SEXP objective,
+                       Rcpp::NumericVector lower,
+                       Rcpp::NumericVector upper,
+                       Rcpp::NumericMatrix initpop,
+                       int iterations,
+                       double cr,
+                       double f,
+                       double c,
+                       double jf,
+                       bool bounceBack,
+                       double precision,
+                       const Control& settings,
+                       const Snapshot* resume) {
+  //////////////
+  // PREAMBLE //
+  //////////////
+
+  // Start checking the termination criteria, along with the wall-clock:
+  Termination termination(settings.target, settings.stagnation, settings.scoreTolerance, settings.parameterTolerance, settings.maxEvaluations, settings.timeLimit);
 
-inline double roundDoubleDownTo(double value, double step) {
-    if (step == 0) {
-        return value;
+  // Get the objective function, and the constraint function to screen candidates with, if any:
+  const Objective fn = createObjective(objective, settings.data, settings.batch, settings.feasibilityTolerance);
+  const Constraint constraint = createConstraint(settings.constraint, settings.data, parseConstraintHandling(settings.constraintHandling),
+                                                 settings.penalty, settings.feasibilityTolerance);
+
+  // Get the incremental objective function to evaluate trials with, if any:
+  const Delta delta = createDelta(settings.delta, settings.data);
+
+  // Checkpoints keep neither the surrogate model, the partial states of incremental evaluations, nor the cache, without
+  // which a resumed run would differ from an uninterrupted one:
+  if (!settings.checkpoint.empty() || resume != NULL) {
+    if (parseSurrogate(settings.surrogate) != SURROGATE_NONE) {
+      Rcpp::stop("Surrogate models are not supported with checkpoints.");
     }
-    else {
-        return floor(value / step) * step;
+    if (delta.active()) {
+      Rcpp::stop("Incremental objective functions are not supported with checkpoints.");
     }
-}
+    if (settings.cache > 0 && settings.maxEvaluations < R_PosInf) {
+      Rcpp::stop("Caches are not supported with checkpoints when the number of evaluations is limited.");
+    }
+  }
 
-inline double roundDoubleUpTo(double value, double step) {
-    if (step == 0) {
-        return value;
+  // First, get the problem dimension:
+  const int dimension = upper.size();
+
+  // Now, get the population size, and the initial one as the population may shrink:
+  const int popsize = initpop.nrow();
+  const int initialPopsize = resume != NULL ? resume->initialPopsize : popsize;
+
+  // Get the lattice to snap trials to, if requested, and snap a copy of the initial population:
+  const std::unique_ptr<Lattice> lattice(settings.lattice ? new Lattice(dimension, lower.begin(), upper.begin(), precision) : NULL);
+  if (lattice.get() != NULL) {
+    initpop = Rcpp::clone(initpop);
+    lattice->snap(initpop.begin(), popsize);
+  }
+
+  // Define the problem:
+  const Problem problem = { dimension, popsize, lower.begin(), upper.begin(), cr, f, c, jf,
+                             parseMutation(settings.mutation), parseCrossover(settings.crossover), parseBoundary(settings.boundary, bounceBack),
+                             precision, &selectKernels(settings.simd), lattice.get() };
+
+  // We need enough candidates to pick the candidate and its donors:
+  if (popsize < donorCount(problem.mutation) + 1) {
+    Rcpp::stop("Population size must be at least " + std::to_string(donorCount(problem.mutation) + 1) + ".");
+  }
+
+  // Select the trial builder specialised for the strategy:
+  const TrialBuilder<Probe> build = selectBuilder<Probe>(problem);
+
+  // Get the population size reduction schedule:
+  const Reduction reduction(parseReduction(settings.reduction), initialPopsize, settings.minPopsize, iterations, settings.maxEvaluations,
+                            settings.popsizes, donorCount(problem.mutation) + 1);
+
+  // Get the random number generator, an internal one if we are multi-threaded:
+  RngKind rngKind = parseRngKind(settings.rng);
+  if (settings.threads > 1 && rngKind == RNG_R) {
+    rngKind = RNG_XOSHIRO;
+  }
+
+  // Create the thread pool if we are multi-threaded:
+  std::unique_ptr<ThreadPool> pool;
+  if (settings.threads > 1) {
+    if (fn.native == NULL) {
+      Rcpp::stop("Multi-threaded evaluation requires a native objective function.");
     }
-    else {
-        return ceil(value / step) * step;
+    if (constraint.active() && constraint.function.native == NULL) {
+      Rcpp::stop("Multi-threaded evaluation requires a native constraint function.");
     }
-}
+    pool.reset(new ThreadPool(settings.threads));
+  }
+
+  // Fork the worker processes to evaluate the R objective function on, if any:
+  Rcpp::Environment rhoenv = Rcpp::Environment::global_env();
+  std::unique_ptr<ProcessPool> processes;
+  if (settings.processes > 0) {
+    processes.reset(new ProcessPool(settings.processes, fn, rhoenv));
+  }
 
-inline double roundToClosest (double value, double step) {
-    double down = roundDoubleDownTo(value, step);
-    double up = roundDoubleUpTo(value, step);
-    if (std::abs(value - down) < std::abs(value - up)) {
-        return down;
+  // Create the surrogate model to pre-screen trials with, if any:
+  std::unique_ptr<Surrogate> surrogate;
+  if (parseSurrogate(settings.surrogate) != SURROGATE_NONE) {
+    if (pool.get() != NULL) {
+      Rcpp::stop("Surrogate pre-screening requires single-threaded evaluation.");
     }
-    return up;
-}
+    surrogate.reset(new Surrogate(dimension, lower.begin(), upper.begin(), settings.surrogateNeighbours, settings.surrogateCapacity,
+                                  settings.surrogateExploration));
+  }
 
+  // Create random number streams, one per thread, with buffers large enough for a generation of trials:
+  const int workers = std::max(1, settings.threads);
+  const int chunk = (initialPopsize + workers - 1) / workers;
+  const uint64_t seed = rngKind == RNG_R || resume != NULL ? 0 : parseSeed(settings.seed);
+  std::vector<Random> streams = createStreams(rngKind, seed, workers, std::max(256, 4 * chunk));
 
-/**
- * Provides precision adjustment.
- *
- * @param vector The vector to be adjusted.
- * @param step Precision step.
- * @return Adjusted vector.
- */
-inline Rcpp::NumericVector precisionAdjustment (Rcpp::NumericVector vector, double step) {
-    for (int i = 0; i < vector.size(); i++) {
-        vector(i) = roundToClosest(vector(i), step);
+  // Create scratch space for building trials, and for the changed elements of incremental evaluations, one per thread:
+  std::vector<std::vector<double> > scratch(workers, std::vector<double>(SCRATCH_ROWS * dimension));
+  std::vector<std::vector<int> > changed(workers, std::vector<int>(delta.active() ? dimension : 0));
+
+  // Create the cache of objective scores, if requested:
+  std::unique_ptr<Cache> cache;
+  std::mutex cacheMutex;
+  if (settings.cache > 0) {
+    cache.reset(new Cache(settings.cache, dimension));
+  }
+
+  // Create the probes, one per thread:
+  Probe probe;
+  std::vector<Probe> probes(workers);
+
+  // Initialize the state, ie. the population and scores along with the buffers for the next generation:
+  State state(popsize, dimension, parseLayout(settings.layout), delta.columns());
+  std::vector<char> screened;
+  double evaluations = popsize;
+  int generation = 0;
+  if (resume != NULL) {
+    // Restore the state, the random number streams and the counters from the snapshot:
+    restoreSnapshot(*resume, state, streams, rngKind, termination);
+    evaluations = resume->evaluations;
+    generation = resume->generation;
+
+    // Re-compute the constraint violations to compare members by:
+    if (constraint.active()) {
+      screenCandidates(constraint, state.population, state.scores, state.violations, screened);
+    }
+  }
+  else {
+    // Screen the initial population with the constraint function, if any, and evaluate the feasible members:
+    state.population.read(initpop.begin());
+    const int infeasible = constraint.active() ? screenCandidates(constraint, state.population, state.scores, state.violations, screened) : 0;
+    Rcpp::NumericVector initialScores = evaluateObjectives(initpop, fn, lower, upper, cache.get(), infeasible > 0 ? screened.data() : NULL);
+    for (int i = 0; i < popsize; i++) {
+      if (infeasible == 0 || !screened[i]) {
+        state.scores[i] = initialScores[i];
+      }
+    }
+    const double calls = popsize - infeasible - (cache.get() != NULL ? cache->hits() : 0.0);
+    evaluations = calls;
+    probe.calls(calls);
+
+    // Get the best score and best candidate:
+    state.findBest();
+
+    // Set the meanCR initially to the crossover:
+    state.meanCR = cr;
+
+    // Set the meanF initially to the crossover:
+    state.meanF = f;
+  }
+
+  // Train the surrogate model on the initial (or resumed) population:
+  if (surrogate.get() != NULL) {
+    surrogate->learn(state.population, state.scores, constraint.active() ? screened.data() : NULL);
+  }
+
+  // Partial states of the initial (or resumed) population are not known yet:
+  if (delta.active()) {
+    forgetPartials(state);
+  }
+
+  // Declare the return value:
+  History history(parseRetention(settings.history), settings.historyEvery, settings.historySize, dimension);
+  Rcpp::List flagsList;
+
+  // Keep the initial (or resumed) population and scores:
+  history.record(generation, state.population, state.scores, state.bestMember, state.bestScore);
+  flagsList.push_back(Rcpp::rep(1, popsize));
+
+  // Open the history file and stream the initial population, if requested:
+  std::unique_ptr<HistoryFile> historyFile;
+  if (!settings.historyFile.empty()) {
+    historyFile.reset(new HistoryFile(settings.historyFile, popsize, dimension));
+    historyFile->append(generation, state.population, state.scores, state.bestMember, state.bestScore, state.meanCR, state.meanF);
+  }
+
+  // Start writing checkpoints in the background, if requested:
+  std::unique_ptr<Checkpoint> checkpoint;
+  if (!settings.checkpoint.empty()) {
+    if (settings.checkpointEvery < 1) {
+      Rcpp::stop("Checkpoint interval must be a positive number.");
+    }
+    checkpoint.reset(new Checkpoint(settings.checkpoint));
+  }
+
+  // Check the termination criteria on the initial population (a resumed one was checked before the checkpoint):
+  Criterion criterion = resume != NULL ? TERMINATE_NONE : termination.check(state.population, state.scores, state.bestScore, evaluations);
+
+  // Repeat as until maximum generation count, ie. iterations, or until a termination criterion fires:
+  while (criterion == TERMINATE_NONE && ++generation < iterations + 1) {
+    // Procedure:
+    //
+    // 1. Mark the beginning of new generation
+    // 2. Iterate over each candidate in the last population and build its trial (see `buildTrial`).
+    //     1. Adjust CR and F if adaptation speed is in use.
+    //     2. Copy the trial from the current candidate.
+    //     3. Pick random candidates from the last population (ideally excluding the current candidate).
+    //     4. Pick which element to start with for the trial.
+    //     5. Modify the elements of the trial as per the crossover and mutation schemes (Actual work)
+    //     6. Apply precision to each element in the trial, if "precision adjustment" is in use.
+    //     7. Apply limits to each element in the trial, in case that we have violated.
+    //     8. Keep the trial along with its CR and F.
+    // 3. Screen trials with the constraint function, if any, and compute the scores of feasible trials, either one
+    //    by one or in one batch call.
+    // 4. Select the next generation (see `selectTrials`):
+    //     1. Assess each trial against its candidate and keep the better one in the spare population buffer.
+    //     2. Update goodCR, goodF and goodF2 for the improved candidates.
+    //     3. Update meanCR and meanF if adaptation speed is in use.
+    //     4. Swap the new population (and scores) with the last one, and update the best member.
+    //     5. Drop the worst members if the population shrinks as per the reduction schedule (see `reducePopulation`).
+    //     6. Check the termination criteria.
+    // 5. Record the generation as per the history retention policy (and stream it to the history file, and checkpoint).
+    // 6. Mark the finishing of new generation.
+
+    // 1. Mark the beginning of new generation
+    // Rcpp::Rcout << "Generation Start: " << generation << std::endl;
+    const typename Probe::Mark start = probe.mark();
+    const double hits = cache.get() != NULL ? cache->hits() : 0.0;
+    const int size = state.population.size();
+
+    // 2. Iterate over each candidate in the last population and build its trial.
+    // 3. Screen trials with the constraint function and the surrogate model, if any, and compute the scores of the
+    //    others.
+    int infeasible = 0;
+    int skipped = 0;
+    if (pool.get() != NULL) {
+      // Build, screen and evaluate trials on the thread pool, each worker with its own stream:
+      const int share = (size + workers - 1) / workers;
+      screened.assign(size, 0);
+      pool->run(workers, [&](int worker) {
+        for (int candidate = worker * share; candidate < std::min(size, (worker + 1) * share); candidate++) {
+          buildTrials(build, streams[worker], problem, state, candidate, candidate + 1, scratch[worker].data(), probes[worker]);
+          typename Probe::Mark mark = probes[worker].mark();
+          const double* trial = state.trials.row(candidate);
+          double& trialScore = state.trialScores[candidate];
+          if (constraint.active() &&
+              constraint.resolve(constraintViolation(constraint, trial, dimension), trialScore, state.trialViolations[candidate])) {
+            screened[candidate] = 1;
+            if (delta.active()) {
+              state.trialPartials(candidate, 0) = R_NaN;
+            }
+            continue;
+          }
+          if (cache.get() != NULL) {
+            std::lock_guard<std::mutex> lock(cacheMutex);
+            if (cache->find(trial, trialScore)) {
+              if (delta.active()) {
+                state.trialPartials(candidate, 0) = R_NaN;
+              }
+              continue;
+            }
+          }
+          if (delta.active()) {
+            trialScore = evaluateDelta(delta, state, candidate, changed[worker].data(), scratch[worker].data());
+          }
+          else {
+            trialScore = fn.native(trial, dimension, fn.data);
+            if (std::isnan(trialScore)) {
+              throw std::runtime_error("NaN value of objective function! \nPerhaps adjust the bounds.");
+            }
+          }
+          if (cache.get() != NULL) {
+            std::lock_guard<std::mutex> lock(cacheMutex);
+            cache->insert(trial, trialScore);
+          }
+          probes[worker].lap(PHASE_EVALUATION, mark);
+        }
+      });
+      infeasible = std::count(screened.begin(), screened.end(), 1);
     }
-  return vector;
+    else {
+      buildTrials(build, streams[0], problem, state, 0, size, scratch[0].data(), probes[0]);
+      typename Probe::Mark mark = probes[0].mark();
+      if (constraint.active()) {
+        infeasible = screenCandidates(constraint, state.trials, state.trialScores, state.trialViolations, screened);
+      }
+      if (surrogate.get() != NULL) {
+        if (!constraint.active()) {
+          // Clear the flags and violations of the trials skipped in the last generation:
+          screened.assign(size, 0);
+          std::fill(state.trialViolations.begin(), state.trialViolations.begin() + size, 0.0);
+        }
+        skipped = surrogate->screen(state.trials, state.scores, state.trialScores, state.trialViolations, screened);
+      }
+      if (delta.active()) {
+        evaluateDeltaTrials(delta, state, cache.get(), infeasible + skipped > 0 ? screened.data() : NULL);
+      }
+      else {
+        evaluateTrials(state.trials, fn, rhoenv, cache.get(), state.trialScores, infeasible + skipped > 0 ? screened.data() : NULL, processes.get());
+      }
+      if (surrogate.get() != NULL) {
+        surrogate->learn(state.trials, state.trialScores, screened.data());
+      }
+      probes[0].lap(PHASE_EVALUATION, mark);
+    }
+    const double calls = size - infeasible - skipped - ((cache.get() != NULL ? cache->hits() : 0.0) - hits);
+    evaluations += calls;
+    probe.calls(calls);
+
+    // 4. Select the next generation, and shrink it if required:
+    typename Probe::Mark mark = probe.mark();
+    probe.replacements(selectTrials(problem, state));
+    if (reduction.enabled()) {
+      reducePopulation(state, reduction.size(generation, evaluations, size));
+    }
+    criterion = termination.check(state.population, state.scores, state.bestScore, evaluations);
+
+    // 5. Record the generation as per the history retention policy (and stream it to the history file, and checkpoint).
+    history.record(generation, state.population, state.scores, state.bestMember, state.bestScore);
+    if (historyFile.get() != NULL) {
+      historyFile->append(generation, state.population, state.scores, state.bestMember, state.bestScore, state.meanCR, state.meanF);
+    }
+    if (checkpoint.get() != NULL && generation % settings.checkpointEvery == 0) {
+      takeSnapshot(checkpoint->spare(), initialPopsize, generation, evaluations, state, streams, rngKind, termination);
+      checkpoint->submit();
+    }
+    probe.lap(PHASE_BOOKKEEPING, mark);
+
+    // 6. Mark the finishing of new generation.
+    // Rcpp::Rcout << "Generation End  : " << generation << std::endl;
+    probe.generation(start);
+  }
+
+  // Make sure that the final generation is kept, ie. the one a criterion fired at, or the last one:
+  history.finish(criterion != TERMINATE_NONE ? generation : generation - 1, state.population, state.scores, state.bestMember, state.bestScore);
+  if (historyFile.get() != NULL) {
+    historyFile->close();
+  }
+  if (checkpoint.get() != NULL) {
+    checkpoint->close();
+  }
+
+  // Collect the statistics of all threads:
+  for (int worker = 0; worker < workers; worker++) {
+    probe.merge(probes[worker]);
+  }
+
+  // Done, return:
+  return Rcpp::List::create(Rcpp::_["problem"] = NULL,
+                            Rcpp::_["results"] = NULL,
+                            Rcpp::_["populations"] = history.populations(),
+                            Rcpp::_["bestmembers"] = history.bestMembers(),
+                            Rcpp::_["bestscores"] = history.bestScores(),
+                            Rcpp::_["popscores"] = history.scores(),
+                            Rcpp::_["popflags"] = flagsList,
+                            Rcpp::_["generations"] = history.generations(),
+                            Rcpp::_["bestmember"] = Rcpp::wrap(state.bestMember),
+                            Rcpp::_["bestscore"] = state.bestScore,
+                            Rcpp::_["termination"] = criterionName(criterion),
+                            Rcpp::_["evaluations"] = evaluations,
+                            Rcpp::_["cachehits"] = cache.get() != NULL ? cache->hits() : 0.0,
+                            Rcpp::_["cachemisses"] = cache.get() != NULL ? cache->misses() : 0.0,
+                            Rcpp::_["stats"] = probe.report()
+                            );
+
+  // return Rcpp::List::create(Rcpp::_["populations"] = populationsList,
+  //                           Rcpp::_["scores"] = scoresList);
 }
 
+
 /**
  * Provides a simple DE routine.
  *
- * @param objective  Objective function.
+ * @param objective  Objective function, either an R function or an external pointer to a native `deflex_objective`.
  * @param lower      Lower-bounds for each parameter to be optimised.
  * @param upper      Upper-bounds for each parameter to be optimised.
  * @param initpop    Initial population.
@@ -60,10 +423,11 @@ inline Rcpp::NumericVector precisionAdjustment (Rcpp::NumericVector vector, doub
  * @param jf         Jitter factor, for example `0.10`.
  * @param bounceBack Whether to bounce back from boundaries or not.
  * @param precision  Precision as a positive number whereby 0 disables it.
+ * @param control    List of optional settings (see `Control`), for example `list(batch = TRUE)`.
  * @return Optimisation result.
  */
 // [[Rcpp::export]]
-SEXP deflex_strategy3 (Rcpp::Function objective,
+SEXP deflex_strategy3 (SEXP objective,
                        Rcpp::NumericVector lower,
                        Rcpp::NumericVector upper,
                        Rcpp::NumericMatrix initpop,
@@ -73,268 +437,708 @@ SEXP deflex_strategy3 (Rcpp::Function objective,
                        double c,
                        double jf,
                        bool bounceBack,
-                       double precision) {
-  //////////////
-  // PREAMBLE //
-  //////////////
+                       double precision,
+                       Rcpp::List control = Rcpp::List::create()) {
+  // Before we start, suspend RNG synchronisation:
+  Rcpp::SuspendRNGSynchronizationScope rngScope;
+
+  // Parse optional settings:
+  const Control settings = parseControl(control);
+
+  // Run with or without instrumentation:
+  if (settings.stats) {
+    return strategy3<Stats>(objective, lower, upper, initpop, iterations, cr, f, c, jf, bounceBack, precision, settings, NULL);
+  }
+  return strategy3<NoStats>(objective, lower, upper, initpop, iterations, cr, f, c, jf, bounceBack, precision, settings, NULL);
+}
 
+
+/**
+ * Resumes the DE routine from a checkpoint (see `control$checkpoint`).
+ *
+ * Given the same arguments and settings as the interrupted run, the
+ * result is the same as the one of an uninterrupted run, except for the
+ * history which starts at the generation of the checkpoint. Caches and
+ * wall-clock time limits start over, hence trials found in the cache
+ * of the interrupted run may count as evaluations. Surrogate models,
+ * incremental objective functions, and caches along with
+ * `control$maxEvaluations` (which drives the termination and the linear
+ * population size reduction) are not supported.
+ *
+ * @param objective  Objective function, either an R function or an external pointer to a native `deflex_objective`.
+ * @param lower      Lower-bounds for each parameter to be optimised.
+ * @param upper      Upper-bounds for each parameter to be optimised.
+ * @param checkpoint Path to the checkpoint file.
+ * @param iterations Number of iterations, including the ones before the checkpoint.
+ * @param cr         Crossover probability from interval `[0, 1]`, for example `0.5`.
+ * @param f          Differential weighting factor from interval `[0, 2]`, for example `0.8`.
+ * @param c          Crossover adaptation speed from interval `(0, 1]`, for example `0.5`.
+ * @param jf         Jitter factor, for example `0.10`.
+ * @param bounceBack Whether to bounce back from boundaries or not.
+ * @param precision  Precision as a positive number whereby 0 disables it.
+ * @param control    List of optional settings (see `Control`), for example `list(checkpoint = "run.ckpt")`.
+ * @return Optimisation result.
+ */
+// [[Rcpp::export]]
+SEXP deflex_resume (SEXP objective,
+                    Rcpp::NumericVector lower,
+                    Rcpp::NumericVector upper,
+                    std::string checkpoint,
+                    int iterations,
+                    double cr,
+                    double f,
+                    double c,
+                    double jf,
+                    bool bounceBack,
+                    double precision,
+                    Rcpp::List control = Rcpp::List::create()) {
   // Before we start, suspend RNG synchronisation:
   Rcpp::SuspendRNGSynchronizationScope rngScope;
 
-  // First, get the problem dimension:
-  const int dimension = upper.size();
+  // Parse optional settings:
+  const Control settings = parseControl(control);
 
-  // Now, get the population size:
-  const int popsize = initpop.nrow();
+  // Read the snapshot:
+  const Snapshot snapshot = readCheckpoint(checkpoint);
+  if (snapshot.dimension != upper.size()) {
+    Rcpp::stop("Checkpoint does not match the problem dimension.");
+  }
 
-  // Create a base vector of random vector indices to be used later:
-  Rcpp::IntegerVector indexVector = Rcpp::wrap(createSequence(0, initpop.nrow()));
+  // Get the population as the initial population for its size:
+  Rcpp::NumericMatrix initpop(snapshot.popsize, snapshot.dimension, snapshot.population.begin());
 
-  // Initialize the scores vector:
-  Rcpp::NumericVector scores = evaluateObjectives(initpop, objective, lower, upper);
+  // Run with or without instrumentation:
+  if (settings.stats) {
+    return strategy3<Stats>(objective, lower, upper, initpop, iterations, cr, f, c, jf, bounceBack, precision, settings, &snapshot);
+  }
+  return strategy3<NoStats>(objective, lower, upper, initpop, iterations, cr, f, c, jf, bounceBack, precision, settings, &snapshot);
+}
 
-  // Get the best score and best candidate:
-  int bestIndex = Rcpp::which_min(scores);
-  double bestScore = scores[bestIndex];
-  Rcpp::NumericMatrix::Row bestIndividual = initpop.row(bestIndex);
 
-  // Declare the return value:
-  Rcpp::List populationsList;
-  Rcpp::List bestMembersList;
-  Rcpp::List scoresList;
-  Rcpp::List bestScoresList;
-  Rcpp::List flagsList;
-  Rcpp::Environment rhoenv = Rcpp::Environment::empty_env();
+/**
+ * Provides the island model of the DE routine.
+ *
+ * The initial population is split into contiguous blocks of rows, one
+ * per island. Islands evolve independently, each with its own random
+ * number stream and CR and F adaptation, and synchronise only to
+ * migrate their best members every `control$migrationInterval`
+ * generations. With more than one thread, islands evolve in parallel,
+ * which requires a native objective function. Termination criteria are
+ * checked at migrations, with `control$stagnation` rounded up to whole
+ * migration intervals.
+ *
+ * @param objective  Objective function, either an R function or an external pointer to a native `deflex_objective`.
+ * @param lower      Lower-bounds for each parameter to be optimised.
+ * @param upper      Upper-bounds for each parameter to be optimised.
+ * @param initpop    Initial population.
+ * @param iterations Number of iterations.
+ * @param cr         Crossover probability from interval `[0, 1]`, for example `0.5`.
+ * @param f          Differential weighting factor from interval `[0, 2]`, for example `0.8`.
+ * @param c          Crossover adaptation speed from interval `(0, 1]`, for example `0.5`.
+ * @param jf         Jitter factor, for example `0.10`.
+ * @param bounceBack Whether to bounce back from boundaries or not.
+ * @param precision  Precision as a positive number whereby 0 disables it.
+ * @param islands    Number of islands.
+ * @param control    List of optional settings (see `Control`), for example `list(topology = "random")`.
+ * @return Optimisation result.
+ */
+// [[Rcpp::export]]
+SEXP deflex_islands (SEXP objective,
+                     Rcpp::NumericVector lower,
+                     Rcpp::NumericVector upper,
+                     Rcpp::NumericMatrix initpop,
+                     int iterations,
+                     double cr,
+                     double f,
+                     double c,
+                     double jf,
+                     bool bounceBack,
+                     double precision,
+                     int islands,
+                     Rcpp::List control = Rcpp::List::create()) {
+  // Before we start, suspend RNG synchronisation:
+  Rcpp::SuspendRNGSynchronizationScope rngScope;
 
-  // Keep the initial population and scores:
-  populationsList.push_back(initpop);
-  bestMembersList.push_back(bestIndividual);
-  scoresList.push_back(scores);
-  bestScoresList.push_back(bestScore);
-  flagsList.push_back(Rcpp::rep(1, popsize));
+  // Parse optional settings:
+  const Control settings = parseControl(control);
+  const Topology topology = parseTopology(settings.topology);
+  if (!Rf_isNull(settings.constraint)) {
+    Rcpp::stop("Constraint functions are not supported by the island model.");
+  }
+  if (!Rf_isNull(settings.delta)) {
+    Rcpp::stop("Incremental objective functions are not supported by the island model.");
+  }
+  rejectControl(control, {"cache", "history", "historyFile", "checkpoint", "reduction", "surrogate", "stats"}, "the island model");
 
-  // Set the meanCR initially to the crossover:
-  double meanCR = cr;
+  // Get the termination criteria, checked at migrations, counting stagnation in epochs between migrations:
+  const int stagnation = settings.migrationInterval > 0 ? (settings.stagnation + settings.migrationInterval - 1) / settings.migrationInterval : 0;
+  Termination termination(settings.target, stagnation, settings.scoreTolerance, settings.parameterTolerance, settings.maxEvaluations, settings.timeLimit);
 
-  // Set the meanF initially to the crossover:
-  double meanF = f;
+  // Get the objective function:
+  const Objective fn = createObjective(objective, settings.data, settings.batch, settings.feasibilityTolerance);
 
-  // Set the goodNPCount:
-  double goodCR = 0.0;
-  double goodF = 0.0;
-  double goodF2 = 0.0;
-  int goodNPCount = 0;
+  // Get the problem dimension and population size:
+  const int dimension = upper.size();
+  const int popsize = initpop.nrow();
 
-  // Initialize the generation counter:
-  int generation = 0;
+  // We need enough candidates per island to pick the candidate and its donors:
+  if (islands < 1) {
+    Rcpp::stop("Number of islands must be positive.");
+  }
+  if (popsize < (donorCount(parseMutation(settings.mutation)) + 1) * islands) {
+    Rcpp::stop("Population size must be at least " + std::to_string(donorCount(parseMutation(settings.mutation)) + 1) + " per island.");
+  }
+  if (settings.migrationInterval < 1) {
+    Rcpp::stop("Migration interval must be a positive number.");
+  }
+  if (settings.migrants < 0 || settings.migrants >= popsize / islands) {
+    Rcpp::stop("Number of migrants must be less than the island population size.");
+  }
 
-  // Repeat as until maximum generation count, ie. iterations:
-  while (++generation < iterations + 1) {
-    // Procedure:
-    //
-    // 1. Mark the beginning of new generation
-    // 2. Preamble: Initialize temporary generation data:
-    //     1. Get the current best member from the last population.
-    //     2. Initialize the new population matrix exactly the same as the last population.
-    //     3. Initialize the new population scores vector the same as the last population scores.
-    //     4. Initialize the new population validity flags vector.
-    // 3. Iterate over each candidate in the last population.
-    //     1. Adjust CR and F if adaptation speed is in use.
-    //     2. Copy the trial from the current candidate.
-    //     3. Pick 2 random candidates from the last population (ideally excluding the current candidate).
-    //     4. Pick which element to start with for the trial.
-    //     5. Iterate over each element in the trial and modify it (Actual work)
-    //     6. Apply precision to each element in the trial, if "precision adjustment" is in use.
-    //     7. Apply limits to each element in the trial, in case that we have violated.
-    //     8. Assess the trial and take actions: Compute the score of the trial.
-    //         1. Compute the trial score.
-    //         2. If trial score is not better than the previous score, keep the new population candidate same as last
-    //            population candidate, and mark the new population candidate index as "unchanged".
-    //         3. Otherwise:
-    //             1. Set the new population candidate to trial.
-    //             2. Update the new population candidate score.
-    //             2. Update goodCR, goodF and goodF2 if adaptation speed is in use.
-    // 4. Epilogue:
-    //     1. Update meanCR and meanF if adaptation speed is in use.
-    //     2. Backup the old population (scores and flags, too)
-    //     3. Set the new population to the canonical population.
-    // 5. Mark the finishing of new generation.
+  // Get the lattice to snap trials to, if requested, and snap a copy of the initial population:
+  const std::unique_ptr<Lattice> lattice(settings.lattice ? new Lattice(dimension, lower.begin(), upper.begin(), precision) : NULL);
+  if (lattice.get() != NULL) {
+    initpop = Rcpp::clone(initpop);
+    lattice->snap(initpop.begin(), popsize);
+  }
 
-    // 1. Mark the beginning of new generation
-    // Rcpp::Rcout << "Generation Start: " << generation << std::endl;
+  // Define the problem:
+  const Problem problem = { dimension, popsize, lower.begin(), upper.begin(), cr, f, c, jf,
+                             parseMutation(settings.mutation), parseCrossover(settings.crossover), parseBoundary(settings.boundary, bounceBack),
+                             precision, &selectKernels(settings.simd), lattice.get() };
 
-    // 2. Preamble: Initialize temporary generation data:
-    //     1. Get the current best member from the last population.
-    Rcpp::NumericVector bestMember = bestMembersList[bestMembersList.size() - 1];
-    Rcpp::NumericVector newBestMember = bestMember;
-    double newBestMemberScore = bestScoresList[bestMembersList.size() - 1];
-
-    //     2. Initialize the new population matrix exactly the same as the last population.
-    Rcpp::NumericMatrix oldPopulation = populationsList[populationsList.size() - 1];
-    Rcpp::NumericMatrix newPopulation(Rcpp::clone(oldPopulation));
-
-    //     3. Initialize the new population scores vector the same as the last population scores.
-    Rcpp::NumericVector oldScores = scoresList[scoresList.size() - 1];
-    Rcpp::NumericVector newScores(Rcpp::clone(oldScores));
-
-    // 3. Iterate over each candidate in the last population.
-    for (int candidate = 0; candidate < newPopulation.rows(); candidate++) {
-      //     1. Adjust CR and F if adaptation speed is in use.
-      if (c > 0) {
-        // Yes. We will now adjust the CR first:
-        cr = Rf_rnorm(meanCR, 0.1);
-
-        // Check and reset CR:
-        cr = cr > 1 ? 1 : (cr < 0 ? 0 : cr);
-
-        // OK, now we will adjust F:
-        do {
-          // Get the new F:
-          f = Rf_rcauchy(meanF, 0.1);
-
-          // Check and reset F if required:
-          f = f > 1 ? 1 : f;
-        } while (f <= 0.0);
-      }
+  // Select the trial builder specialised for the strategy:
+  const TrialBuilder<NoStats> build = selectBuilder<NoStats>(problem);
 
-      //     2. Copy the trial from the current candidate.
-      Rcpp::NumericVector oldCandidate = newPopulation(candidate, Rcpp::_);
-      Rcpp::NumericVector trial(Rcpp::clone(oldCandidate));
-
-      //     3. Pick 2 random candidates from the last population (ideally excluding the current candidate).
-      // TODO: XXX
-      Rcpp::IntegerVector tidx = indexVector[indexVector != candidate];
-      Rcpp::IntegerVector ridx = Rcpp::sample(tidx, 2);
-
-      //     4. Pick which element to start with for the trial.
-      int j = Rcpp::sample(dimension, 1)[0] - 1;
-      int k = 0;
-
-      //     5. Iterate over each element in the trial and modify it (Actual work)
-      do {
-        // Get a random:
-        const double rr = Rf_runif(0, 1);
-
-        // Get the jitter:
-        const double jitter = (rr * jf) + f;
-
-        // Get the respective element of the best candidate:
-        const double bestest = bestMember[j];
-
-        // Get the random candidate elements:
-        const double random1 = oldPopulation(ridx[0], j);
-        const double random2 = oldPopulation(ridx[1], j);
-
-        // Override trial:
-        trial[j] = bestest + jitter * (random1 - random2);
-
-        // Check for a weird case that we get NaN:
-        if(ISNAN(trial[j])) {
-          // TODO: Something funny here.
-          //
-          // It was due to the tidx statement and underlying
-          // indexVector which was based on 1 previously. Shouldn't
-          // repeat again, yet just on case for now.
-          //
-          // Rcpp::Rcout << bestest << " " << jitter << "(" << jf << ", " << f <<  ", " << rr << ")" << " " <<  random1 << " " << random2 << std::endl;
-          trial[j] = (upper[j] + lower[j]) / 2.0;
-        }
+  // Get the random number generator, an internal one if we are multi-threaded:
+  RngKind rngKind = parseRngKind(settings.rng);
+  if (settings.threads > 1 && rngKind == RNG_R) {
+    rngKind = RNG_XOSHIRO;
+  }
 
-        // Move to the next element:
-        j = (j + 1) % dimension;
+  // Create the thread pool if we are multi-threaded:
+  std::unique_ptr<ThreadPool> pool;
+  if (settings.threads > 1) {
+    if (fn.native == NULL) {
+      Rcpp::stop("Multi-threaded evaluation requires a native objective function.");
+    }
+    pool.reset(new ThreadPool(settings.threads));
+  }
 
-        // Increment k:
-        k++;
-      } while (Rf_runif(0, 1) < cr && k < dimension);
+  // Fork the worker processes to evaluate the R objective function on, if any:
+  Rcpp::Environment rhoenv = Rcpp::Environment::global_env();
+  std::unique_ptr<ProcessPool> processes;
+  if (settings.processes > 0) {
+    processes.reset(new ProcessPool(settings.processes, fn, rhoenv));
+  }
 
-      //     6. Apply precision to each element in the trial, if "precision adjustment" is in use.
-      //     7. Apply limits to each element in the trial, in case that we have violated.
-      for (int i = 0; i < trial.size(); i++) {
-        // Adjust as per precision:
-        if (precision != 0) {
-            trial[i] = roundToClosest(trial[i], precision);
-        }
+  // Create random number streams, one per island and one for migrations:
+  const uint64_t seed = rngKind == RNG_R ? 0 : parseSeed(settings.seed);
+  std::vector<Random> streams = createStreams(rngKind, seed, islands + 1, std::max(256, 4 * popsize / islands));
 
-        // Check lower limit:
-        if (trial[i] < lower[i]) {
-          if (bounceBack) {
-            trial[i] = lower[i] + Rf_runif(0, 1) * (upper[i] - lower[i]);
-          }
-          else {
-            trial[i] = lower[i];
-          }
-        }
+  // Evaluate the initial population:
+  Rcpp::NumericVector initialScores = evaluateObjectives(initpop, fn, lower, upper);
 
-        // Check upper limit:
-        if (trial[i] > upper[i]) {
-          if (bounceBack) {
-            trial[i] = lower[i] - Rf_runif(0, 1) * (upper[i] - lower[i]);
-          }
-          else {
-            trial[i] = upper[i];
+  // Initialize islands, each with a contiguous block of the initial population:
+  const Layout layout = parseLayout(settings.layout);
+  std::vector<State> states;
+  states.reserve(islands);
+  std::vector<std::vector<double> > scratch(islands, std::vector<double>(SCRATCH_ROWS * dimension));
+  for (int k = 0; k < islands; k++) {
+    const int from = k * popsize / islands;
+    const int to = (k + 1) * popsize / islands;
+    states.push_back(State(to - from, dimension, layout));
+    State& state = states.back();
+    for (int i = from; i < to; i++) {
+      for (int j = 0; j < dimension; j++) {
+        scratch[k][j] = initpop(i, j);
+      }
+      state.population.assign(i - from, scratch[k].data());
+      state.scores[i - from] = initialScores[i];
+    }
+    state.findBest();
+    state.meanCR = cr;
+    state.meanF = f;
+  }
+
+  // Define the evolution of an island for a number of generations:
+  auto evolve = [&] (int island, int generations) {
+    State& state = states[island];
+    for (int generation = 0; generation < generations; generation++) {
+      buildTrials(build, streams[island], problem, state, 0, state.population.size(), scratch[island].data());
+      if (pool.get() != NULL) {
+        for (int candidate = 0; candidate < state.population.size(); candidate++) {
+          state.trialScores[candidate] = fn.native(state.trials.row(candidate), dimension, fn.data);
+          if (std::isnan(state.trialScores[candidate])) {
+            throw std::runtime_error("NaN value of objective function! \nPerhaps adjust the bounds.");
           }
         }
       }
+      else {
+        evaluateTrials(state.trials, fn, rhoenv, NULL, state.trialScores, NULL, processes.get());
+      }
+      selectTrials(problem, state);
+    }
+  };
 
-      //     8. Assess the trial and take actions: Compute the score of the trial.
-      //         1. Compute the trial score.
-      //double trialScore = Rcpp::as<double>(objective(trial));
-      double trialScore = evaluate(trial, objective, rhoenv);
-
-      //         2. If trial score is not better than the previous score, keep the new population candidate same as last
-      //            population candidate, and mark the new population candidate index as "unchanged".
-      //         3. Otherwise:
-      //             1. Set the new population candidate to trial.
-      //             2. Update the new population candidate score.
-      //             2. Update goodCR, goodF and goodF2 if adaptation speed is in use.
-      if (trialScore < oldScores[candidate]) {
-        newPopulation(candidate, Rcpp::_) = trial;
-        newScores[candidate] = trialScore;
-
-        goodCR += cr / ++goodNPCount;
-        goodF += f;
-        goodF2 += std::pow(f, 2);
-
-        if (trialScore < bestScore) {
-          bestScore = trialScore;
-          newBestMember = trial;
-          newBestMemberScore = trialScore;
-        }
+  // Define the gathering of islands into the whole population, returning the island with the best member:
+  Population population(popsize, dimension, layout);
+  std::vector<double> scores(popsize);
+  auto gather = [&] () {
+    int best = 0;
+    for (int k = 0, i = 0; k < islands; k++) {
+      const State& state = states[k];
+      for (int m = 0; m < state.population.size(); m++, i++) {
+        population.assign(i, state.population, m);
+        scores[i] = state.scores[m];
       }
+      best = state.bestScore < states[best].bestScore ? k : best;
     }
-    // 4. Epilogue:
-    //     1. Update meanCR and meanF if adaptation speed is in use.
-    //     2. Backup the old population (scores and flags, too)
-    //     3. Set the new population to the canonical population.
-    // Re-compute mean CR and F if required:
-    if (c > 0 && goodF != 0) {
-      meanCR = (1.0 - c) * meanCR + c * goodCR;
-      meanF  = (1.0 - c) * meanF  + c * goodF2 / goodF;
+    return best;
+  };
+
+  // Evolve islands until the next migration, and migrate, until a termination criterion fires:
+  double evaluations = popsize;
+  Criterion criterion = termination.check(population, scores, states[gather()].bestScore, evaluations);
+  for (int generation = 0; criterion == TERMINATE_NONE && generation < iterations; ) {
+    const int epoch = std::min<double>(std::min(settings.migrationInterval, iterations - generation),
+                                       std::floor((settings.maxEvaluations - evaluations) / popsize));
+    if (pool.get() != NULL) {
+      pool->run(islands, [&] (int island) { evolve(island, epoch); });
     }
+    else {
+      for (int island = 0; island < islands; island++) {
+        evolve(island, epoch);
+      }
+    }
+    generation += epoch;
+    evaluations += static_cast<double>(popsize) * epoch;
+    criterion = termination.check(population, scores, states[gather()].bestScore, evaluations);
+    if (criterion == TERMINATE_NONE && generation < iterations) {
+      migrate(states, topology, settings.migrants, streams[islands]);
+    }
+  }
 
-    // Add stuff:
-    populationsList.push_back(newPopulation);
-    scoresList.push_back(newScores);
-    bestMembersList.push_back(newBestMember);
-    bestScoresList.push_back(newBestMemberScore);
+  // Collect the final population, scores and the best of each island:
+  const int best = gather();
+  Rcpp::NumericMatrix finalPopulation(popsize, dimension);
+  population.write(finalPopulation.begin());
+  Rcpp::NumericVector islandScores(islands);
+  for (int k = 0; k < islands; k++) {
+    islandScores[k] = states[k].bestScore;
+  }
 
-    // 5. Mark the finishing of new generation.
-    // Rcpp::Rcout << "Generation End  : " << generation << std::endl;
+  // Done, return:
+  return Rcpp::List::create(Rcpp::_["population"] = finalPopulation,
+                            Rcpp::_["popscores"] = Rcpp::wrap(scores),
+                            Rcpp::_["islandscores"] = islandScores,
+                            Rcpp::_["bestmember"] = Rcpp::wrap(states[best].bestMember),
+                            Rcpp::_["bestscore"] = states[best].bestScore,
+                            Rcpp::_["termination"] = criterionName(criterion),
+                            Rcpp::_["evaluations"] = evaluations
+                            );
+}
+
+
+/**
+ * Provides the asynchronous steady-state mode of the DE routine.
+ *
+ * Trials are built from the current population and pushed into a
+ * bounded pipeline served by evaluator threads. As soon as the score
+ * of a trial arrives, the trial replaces its candidate if better, so
+ * that improvements are visible to the trials built afterwards. There
+ * is no generational barrier, hence evaluators are kept busy even if
+ * evaluation times vary a lot. Termination criteria are checked on
+ * every arrival, no trial is submitted beyond `maxEvaluations`, and CR
+ * and F are adapted, and generations counted towards `stagnation`,
+ * every `popsize` arrivals.
+ *
+ * With more than one thread, which requires a native objective
+ * function, results depend on the order scores arrive in and are not
+ * reproducible. With one thread, trials are evaluated one by one and
+ * results are reproducible.
+ *
+ * @param objective  Objective function, either an R function or an external pointer to a native `deflex_objective`.
+ * @param lower      Lower-bounds for each parameter to be optimised.
+ * @param upper      Upper-bounds for each parameter to be optimised.
+ * @param initpop    Initial population.
+ * @param iterations Number of iterations, ie. `iterations * popsize` trials are evaluated at most.
+ * @param cr         Crossover probability from interval `[0, 1]`, for example `0.5`.
+ * @param f          Differential weighting factor from interval `[0, 2]`, for example `0.8`.
+ * @param c          Crossover adaptation speed from interval `(0, 1]`, for example `0.5`.
+ * @param jf         Jitter factor, for example `0.10`.
+ * @param bounceBack Whether to bounce back from boundaries or not.
+ * @param precision  Precision as a positive number whereby 0 disables it.
+ * @param control    List of optional settings (see `Control`), for example `list(threads = 8)`.
+ * @return Optimisation result.
+ */
+// [[Rcpp::export]]
+SEXP deflex_async (SEXP objective,
+                   Rcpp::NumericVector lower,
+                   Rcpp::NumericVector upper,
+                   Rcpp::NumericMatrix initpop,
+                   int iterations,
+                   double cr,
+                   double f,
+                   double c,
+                   double jf,
+                   bool bounceBack,
+                   double precision,
+                   Rcpp::List control = Rcpp::List::create()) {
+  // Before we start, suspend RNG synchronisation:
+  Rcpp::SuspendRNGSynchronizationScope rngScope;
+
+  // Parse optional settings:
+  const Control settings = parseControl(control);
+
+  if (!Rf_isNull(settings.constraint)) {
+    Rcpp::stop("Constraint functions are not supported by the asynchronous mode.");
+  }
+  if (!Rf_isNull(settings.delta)) {
+    Rcpp::stop("Incremental objective functions are not supported by the asynchronous mode.");
+  }
+  rejectControl(control, {"processes", "cache", "reduction", "surrogate", "history", "historyFile", "checkpoint", "stats"}, "the asynchronous mode");
+
+  // Start checking the termination criteria, along with the wall-clock:
+  Termination termination(settings.target, settings.stagnation, settings.scoreTolerance, settings.parameterTolerance, settings.maxEvaluations, settings.timeLimit);
+
+  // Get the objective function:
+  const Objective fn = createObjective(objective, settings.data, settings.batch, settings.feasibilityTolerance);
+
+  // Get the problem dimension and population size:
+  const int dimension = upper.size();
+  const int popsize = initpop.nrow();
+
+  // Get the lattice to snap trials to, if requested, and snap a copy of the initial population:
+  const std::unique_ptr<Lattice> lattice(settings.lattice ? new Lattice(dimension, lower.begin(), upper.begin(), precision) : NULL);
+  if (lattice.get() != NULL) {
+    initpop = Rcpp::clone(initpop);
+    lattice->snap(initpop.begin(), popsize);
+  }
+
+  // Define the problem:
+  const Problem problem = { dimension, popsize, lower.begin(), upper.begin(), cr, f, c, jf,
+                             parseMutation(settings.mutation), parseCrossover(settings.crossover), parseBoundary(settings.boundary, bounceBack),
+                             precision, &selectKernels(settings.simd), lattice.get() };
+
+  // We need enough candidates to pick the candidate and its donors:
+  if (popsize < donorCount(problem.mutation) + 1) {
+    Rcpp::stop("Population size must be at least " + std::to_string(donorCount(problem.mutation) + 1) + ".");
+  }
+
+  // Select the trial builder specialised for the strategy:
+  const TrialBuilder<NoStats> build = selectBuilder<NoStats>(problem);
+
+  // Get the random number generator, an internal one if we are multi-threaded:
+  RngKind rngKind = parseRngKind(settings.rng);
+  if (settings.threads > 1 && rngKind == RNG_R) {
+    rngKind = RNG_XOSHIRO;
+  }
+  if (settings.threads > 1 && fn.native == NULL) {
+    Rcpp::stop("Multi-threaded evaluation requires a native objective function.");
+  }
+
+  // Create the random number stream (trials are built on this thread only):
+  const uint64_t seed = rngKind == RNG_R ? 0 : parseSeed(settings.seed);
+  std::vector<Random> streams = createStreams(rngKind, seed, 1, 256);
+  std::vector<double> scratch(SCRATCH_ROWS * dimension);
+  NoStats probe;
+
+  // Initialize the state:
+  State state(popsize, dimension, parseLayout(settings.layout));
+  state.population.read(initpop.begin());
+  Rcpp::NumericVector initialScores = evaluateObjectives(initpop, fn, lower, upper);
+  std::copy(initialScores.begin(), initialScores.end(), state.scores.begin());
+  state.findBest();
+  state.meanCR = cr;
+  state.meanF = f;
+
+  // Define the evaluation, thread-safe for native objective functions:
+  Rcpp::Environment rhoenv = Rcpp::Environment::global_env();
+  std::function<double(const double*)> evaluation = [&] (const double* trial) {
+    if (fn.native == NULL) {
+      return evaluate(Rcpp::NumericVector(trial, trial + dimension), fn.function, rhoenv);
+    }
+    const double score = fn.native(trial, dimension, fn.data);
+    if (std::isnan(score)) {
+      throw std::runtime_error("NaN value of objective function! \nPerhaps adjust the bounds.");
+    }
+    return score;
+  };
+
+  // Create the pipeline:
+  const int threads = std::max(1, settings.threads);
+  const int capacity = std::min(popsize, settings.queueSize > 0 ? settings.queueSize : 2 * threads);
+  Pipeline pipeline(threads > 1 ? threads : 0, capacity, dimension, evaluation);
+
+  // Keep track of candidates with a trial in the pipeline:
+  std::vector<char> busy(popsize, 0);
+  int next = 0;
+
+  // Initialize counters:
+  const double budget = static_cast<double>(popsize) * iterations;
+  double evaluations = popsize;
+  double submitted = 0;
+  double arrived = 0;
+  termination.count(state.bestScore);
+  Criterion criterion = termination.poll(state.population, state.scores, state.bestScore, evaluations, 1);
+
+  // Keep the pipeline full and apply scores as they arrive:
+  while (true) {
+    // Build trials for the next idle candidates as long as there is room in the pipeline (hence an idle candidate),
+    // and in the evaluation budget given the trials in flight:
+    while (criterion == TERMINATE_NONE && submitted < budget && evaluations + pipeline.inflight() < settings.maxEvaluations && pipeline.available() > 0) {
+      while (busy[next]) {
+        next = (next + 1) % popsize;
+      }
+      const int slot = pipeline.acquire();
+      build(streams[0], problem, state.meanCR, state.meanF, state.population, state.bestMember.data(), next,
+            pipeline.trial(slot), state.trialCR[next], state.trialF[next], scratch.data(), probe);
+      pipeline.submit(slot, next);
+      busy[next] = 1;
+      next = (next + 1) % popsize;
+      submitted++;
+    }
+
+    // Are we done?
+    if (pipeline.inflight() == 0) {
+      break;
+    }
+
+    // Take the next score and replace the candidate if its trial is better:
+    const int slot = pipeline.receive();
+    const int candidate = pipeline.tag(slot);
+    const double trialScore = pipeline.score(slot);
+    busy[candidate] = 0;
+    arrived++;
+    evaluations++;
+    if (trialScore < state.scores[candidate]) {
+      state.population.assign(candidate, pipeline.trial(slot));
+      state.scores[candidate] = trialScore;
+      recordSuccess(state, candidate);
+      if (trialScore < state.bestScore) {
+        state.bestScore = trialScore;
+        std::copy(pipeline.trial(slot), pipeline.trial(slot) + dimension, state.bestMember.begin());
+      }
+    }
+    pipeline.release(slot);
+
+    // Adapt CR and F, and count a generation every popsize arrivals, and check termination criteria:
+    if (std::fmod(arrived, popsize) == 0) {
+      adaptParameters(problem, state);
+      termination.count(state.bestScore);
+    }
+    if (criterion == TERMINATE_NONE) {
+      criterion = termination.poll(state.population, state.scores, state.bestScore, evaluations, 1);
+    }
   }
 
+  // Get the final population:
+  Rcpp::NumericMatrix population(popsize, dimension);
+  state.population.write(population.begin());
 
   // Done, return:
-  return Rcpp::List::create(Rcpp::_["problem"] = NULL,
-                            Rcpp::_["results"] = NULL,
-                            Rcpp::_["populations"] = populationsList,
-                            Rcpp::_["bestmembers"] = bestMembersList,
-                            Rcpp::_["bestscores"] = bestScoresList,
-                            Rcpp::_["popscores"] = scoresList,
-                            Rcpp::_["popflags"] = flagsList,
-                            Rcpp::_["bestmember"] = bestMembersList[bestMembersList.size() - 1],
-                            Rcpp::_["bestscore"] = bestScoresList[bestScoresList.size() - 1]
+  return Rcpp::List::create(Rcpp::_["population"] = population,
+                            Rcpp::_["popscores"] = Rcpp::wrap(state.scores),
+                            Rcpp::_["bestmember"] = Rcpp::wrap(state.bestMember),
+                            Rcpp::_["bestscore"] = state.bestScore,
+                            Rcpp::_["termination"] = criterionName(criterion),
+                            Rcpp::_["evaluations"] = evaluations
                             );
+}
 
-  // return Rcpp::List::create(Rcpp::_["populations"] = populationsList,
-  //                           Rcpp::_["scores"] = scoresList);
+
+/**
+ * Runs many independent optimisations in one call.
+ *
+ * Jobs are parsed up front. With more than one thread, jobs with native
+ * objective and constraint functions run in parallel, one job per thread at a time,
+ * the most expensive ones first so that the threads finish together.
+ * Jobs with R objective functions run on the main thread afterwards.
+ * Each job evolves the same as the single-threaded DE routine with the
+ * same settings and seed. Worker processes, caches, surrogate models,
+ * incremental objective functions and multi-threaded jobs are not
+ * supported. Settings which do not affect the search (history,
+ * checkpoints and statistics) are ignored.
+ *
+ * @param jobs    List of jobs, each a list with the arguments of `deflex_strategy3`
+ *                (`objective`, `lower`, `upper`, `initpop`, `iterations`, `cr`, `f`,
+ *                `c`, `jf`, `bounceBack`, `precision` and optional `control`).
+ * @param threads Number of threads to run jobs on.
+ * @return Summaries of the jobs as a list of `bestscore`, `bestmember`, `evaluations`,
+ *         `generations`, `termination` and `seconds` elements, one entry per job.
+ */
+// [[Rcpp::export]]
+SEXP deflex_batch (Rcpp::List jobs, int threads = 1) {
+  // Before we start, suspend RNG synchronisation:
+  Rcpp::SuspendRNGSynchronizationScope rngScope;
+
+  // Parse jobs, and split the ones which can run in parallel:
+  std::vector<Job> parsed;
+  std::vector<int> parallel;
+  std::vector<int> serial;
+  for (int i = 0; i < jobs.size(); i++) {
+    parsed.push_back(parseJob(jobs[i]));
+    const Job& job = parsed.back();
+    const bool native = job.objective.native != NULL && (!job.constraint.active() || job.constraint.function.native != NULL);
+    (threads > 1 && native ? parallel : serial).push_back(i);
+  }
+
+  // Run the most expensive jobs first:
+  std::stable_sort(parallel.begin(), parallel.end(), [&parsed] (int a, int b) { return jobCost(parsed[a]) > jobCost(parsed[b]); });
+
+  // Run jobs on the thread pool, each thread taking the next job as soon as it is done:
+  std::vector<Summary> summaries(parsed.size());
+  if (!parallel.empty()) {
+    ThreadPool pool(std::min(threads, static_cast<int>(parallel.size())));
+    pool.run(parallel.size(), [&] (int k) {
+      try {
+        summaries[parallel[k]] = runJob(parsed[parallel[k]]);
+      }
+      catch (const std::exception& e) {
+        throw std::runtime_error("Job " + std::to_string(parallel[k] + 1) + ": " + e.what());
+      }
+    });
+  }
+
+  // Run the rest of jobs on the main thread:
+  for (size_t k = 0; k < serial.size(); k++) {
+    summaries[serial[k]] = runJob(parsed[serial[k]]);
+  }
+
+  // Collect the summaries:
+  const int count = summaries.size();
+  std::vector<double> bestScores(count);
+  Rcpp::List bestMembers(count);
+  std::vector<double> evaluations(count);
+  std::vector<int> generations(count);
+  std::vector<std::string> terminations(count);
+  std::vector<double> seconds(count);
+  for (int i = 0; i < count; i++) {
+    bestScores[i] = summaries[i].bestScore;
+    bestMembers[i] = Rcpp::wrap(summaries[i].bestMember);
+    evaluations[i] = summaries[i].evaluations;
+    generations[i] = summaries[i].generations;
+    terminations[i] = criterionName(summaries[i].criterion);
+    seconds[i] = summaries[i].seconds;
+  }
+
+  // Done, return:
+  return Rcpp::List::create(Rcpp::_["bestscore"] = Rcpp::wrap(bestScores),
+                            Rcpp::_["bestmember"] = bestMembers,
+                            Rcpp::_["evaluations"] = Rcpp::wrap(evaluations),
+                            Rcpp::_["generations"] = Rcpp::wrap(generations),
+                            Rcpp::_["termination"] = Rcpp::wrap(terminations),
+                            Rcpp::_["seconds"] = Rcpp::wrap(seconds)
+                            );
+}
+
+
+/**
+ * Generates an initial population within bounds (see `samplePopulation`).
+ *
+ * The seed is decorrelated from the one of the evolution, so that the
+ * same seed can be used for both.
+ *
+ * @param lower     Lower-bounds for each parameter to be optimised.
+ * @param upper     Upper-bounds for each parameter to be optimised.
+ * @param popsize   Population size.
+ * @param generator Generator name (see `parseSampling`).
+ * @param seed      The seed, or `NA` to draw it from R's random number generator.
+ * @return The population, one member per row.
+ */
+static Rcpp::NumericMatrix sampleInitpop (Rcpp::NumericVector lower, Rcpp::NumericVector upper, int popsize, const std::string& generator, double seed) {
+  // Check the arguments:
+  const SamplingKind kind = parseSampling(generator);
+  if (lower.size() != upper.size()) {
+    Rcpp::stop("Lower- and upper-bounds must be of the same length.");
+  }
+  for (int j = 0; j < lower.size(); j++) {
+    if (!std::isfinite(lower[j]) || !std::isfinite(upper[j]) || lower[j] > upper[j]) {
+      Rcpp::stop("Bounds must be finite, and lower-bounds must not exceed upper-bounds.");
+    }
+  }
+  if (popsize < 1) {
+    Rcpp::stop("Population size must be positive.");
+  }
+
+  // Generate the population:
+  const uint64_t base = parseSeed(seed);
+  Rcpp::NumericMatrix retval(popsize, lower.size());
+  samplePopulation(kind, popsize, lower.size(), lower.begin(), upper.begin(), base ^ 0x5bd1e9955bd1e995ULL, retval.begin());
+
+  // Done, return:
+  return retval;
+}
+
+
+/**
+ * Generates a space-filling initial population within bounds.
+ *
+ * @param lower     Lower-bounds for each parameter to be optimised.
+ * @param upper     Upper-bounds for each parameter to be optimised.
+ * @param popsize   Population size.
+ * @param generator One of `"sobol"` (scrambled Sobol sequence), `"halton"` (scrambled Halton sequence),
+ *                  `"lhs"` (Latin hypercube) or `"uniform"` (independent uniform draws).
+ * @param seed      The seed, or `NA` to draw it from R's random number generator.
+ * @return The population, one member per row.
+ */
+// [[Rcpp::export]]
+Rcpp::NumericMatrix deflex_initpop (Rcpp::NumericVector lower,
+                                   Rcpp::NumericVector upper,
+                                   int popsize,
+                                   std::string generator = "sobol",
+                                   double seed = NA_REAL) {
+  return sampleInitpop(lower, upper, popsize, generator, seed);
+}
+
+
+/**
+ * Provides the DE routine starting from a generated initial population.
+ *
+ * Same as `deflex_strategy3` with `deflex_initpop(lower, upper, popsize,
+ * generator, control$seed)` as the initial population, which is
+ * generated in C++ instead of being built by R code and passed in.
+ *
+ * @param objective  Objective function, either an R function or an external pointer to a native `deflex_objective`.
+ * @param lower      Lower-bounds for each parameter to be optimised.
+ * @param upper      Upper-bounds for each parameter to be optimised.
+ * @param popsize    Population size.
+ * @param generator  Initial population generator (see `deflex_initpop`), for example `"sobol"`.
+ * @param iterations Number of iterations.
+ * @param cr         Crossover probability from interval `[0, 1]`, for example `0.5`.
+ * @param f          Differential weighting factor from interval `[0, 2]`, for example `0.8`.
+ * @param c          Crossover adaptation speed from interval `(0, 1]`, for example `0.5`.
+ * @param jf         Jitter factor, for example `0.10`.
+ * @param bounceBack Whether to bounce back from boundaries or not.
+ * @param precision  Precision as a positive number whereby 0 disables it.
+ * @param control    List of optional settings (see `Control`), for example `list(seed = 42)`.
+ * @return Optimisation result.
+ */
+// [[Rcpp::export]]
+SEXP deflex_strategy3_generated (SEXP objective,
+                                 Rcpp::NumericVector lower,
+                                 Rcpp::NumericVector upper,
+                                 int popsize,
+                                 std::string generator,
+                                 int iterations,
+                                 double cr,
+                                 double f,
+                                 double c,
+                                 double jf,
+                                 bool bounceBack,
+                                 double precision,
+                                 Rcpp::List control = Rcpp::List::create()) {
+  // Before we start, suspend RNG synchronisation:
+  Rcpp::SuspendRNGSynchronizationScope rngScope;
+
+  // Parse optional settings, and generate the initial population:
+  const Control settings = parseControl(control);
+  Rcpp::NumericMatrix initpop = sampleInitpop(lower, upper, popsize, generator, settings.seed);
+
+  // Run with or without instrumentation:
+  if (settings.stats) {
+    return strategy3<Stats>(objective, lower, upper, initpop, iterations, cr, f, c, jf, bounceBack, precision, settings, NULL);
+  }
+  return strategy3<NoStats>(objective, lower, upper, initpop, iterations, cr, f, c, jf, bounceBack, precision, settings, NULL);
 }
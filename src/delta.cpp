@@ -0,0 +1,100 @@
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include "delta.h"
+
+Delta createDelta (SEXP delta, SEXP data) {
+  // Declare the return value:
+  Delta retval;
+  retval.functions = NULL;
+  retval.data = NULL;
+
+  // Get the incremental objective function, if any:
+  if (Rf_isNull(delta)) {
+    return retval;
+  }
+  if (TYPEOF(delta) != EXTPTRSXP) {
+    Rcpp::stop("Incremental objective must be an external pointer to a deflex_delta.");
+  }
+  retval.functions = static_cast<const deflex_delta*>(R_ExternalPtrAddr(delta));
+  if (retval.functions == NULL || retval.functions->evaluate == NULL || retval.functions->update == NULL || retval.functions->size < 0) {
+    Rcpp::stop("Incremental objective must have both functions and a non-negative state size.");
+  }
+
+  // Get the user data as for native objective functions:
+  if (TYPEOF(data) == EXTPTRSXP) {
+    retval.data = R_ExternalPtrAddr(data);
+  }
+  else if (!Rf_isNull(data)) {
+    retval.data = data;
+  }
+
+  // Done, return:
+  return retval;
+}
+
+
+void forgetPartials (State& state) {
+  for (int i = 0; i < state.population.size(); i++) {
+    state.partials(i, 0) = std::numeric_limits<double>::quiet_NaN();
+  }
+}
+
+
+double evaluateDelta (const Delta& delta, State& state, int candidate, int* changed, double* buffer) {
+  // Get the trial, and the partial states of the candidate and the trial:
+  const int dimension = state.trials.width();
+  const double* trial = state.trials.row(candidate);
+  const double* known = state.partials.row(candidate);
+  double* next = state.trialPartials.row(candidate);
+
+  // Evaluate from scratch if the partial state of the candidate is not known:
+  double score;
+  if (std::isnan(known[0])) {
+    score = delta.functions->evaluate(trial, dimension, next + 1, delta.data);
+  }
+  else {
+    // Find the elements changed:
+    const double* parent = state.population.row(candidate, buffer);
+    int count = 0;
+    for (int j = 0; j < dimension; j++) {
+      if (trial[j] != parent[j]) {
+        changed[count++] = j;
+      }
+    }
+
+    // Take over the candidate if nothing changed, or update its score otherwise:
+    if (count == 0) {
+      std::copy(known, known + state.partials.width(), next);
+      return known[0];
+    }
+    score = delta.functions->update(trial, dimension, changed, count, parent, known[0], known + 1, next + 1, delta.data);
+  }
+
+  // Check and keep the score:
+  if (std::isnan(score)) {
+    throw std::runtime_error("NaN value of objective function! \nPerhaps adjust the bounds.");
+  }
+  next[0] = score;
+  return score;
+}
+
+
+void evaluateDeltaTrials (const Delta& delta, State& state, Cache* cache, const char* screened) {
+  // Create the index and element buffers:
+  const int dimension = state.trials.width();
+  std::vector<int> changed(dimension);
+  std::vector<double> buffer(dimension);
+
+  // Iterate over trials, leaving the partial states of the ones not evaluated unknown:
+  for (int i = 0; i < state.trials.size(); i++) {
+    if ((screened != NULL && screened[i]) || (cache != NULL && cache->find(state.trials.row(i), state.trialScores[i]))) {
+      state.trialPartials(i, 0) = std::numeric_limits<double>::quiet_NaN();
+      continue;
+    }
+    state.trialScores[i] = evaluateDelta(delta, state, i, changed.data(), buffer.data());
+    if (cache != NULL) {
+      cache->insert(state.trials.row(i), state.trialScores[i]);
+    }
+  }
+}
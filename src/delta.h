@@ -0,0 +1,91 @@
+#include <vector>
+#include <Rcpp.h>
+#include "deflex.h"
+#include "engine.h"
+#include "cache.h"
+
+#ifndef deflex_delta_h
+#define deflex_delta_h
+
+/**
+ * Provides the incremental objective function which evaluates trials
+ * from their candidates (see `deflex_delta`).
+ *
+ * Partial states are kept in the `partials` of the state, and are not
+ * known for the initial (or resumed) population, for members screened
+ * out, and for members found in the cache. Trials of such candidates
+ * are evaluated from scratch, the others from the elements which
+ * differ from their candidates. Differences are found element by
+ * element, so that any crossover, rounding and repair is accounted for.
+ */
+struct Delta {
+  /**
+   * The incremental objective function (inactive if `NULL`).
+   */
+  const deflex_delta* functions;
+
+  /**
+   * User data passed to the functions.
+   */
+  void* data;
+
+  /**
+   * @return Whether the incremental objective function is in use.
+   */
+  bool active () const {
+    return functions != NULL;
+  }
+
+  /**
+   * @return Number of columns of partial states, ie. the score and the
+   *         partial state (0 if not in use).
+   */
+  int columns () const {
+    return functions != NULL ? functions->size + 1 : 0;
+  }
+};
+
+
+/**
+ * Creates the incremental objective function.
+ *
+ * @param delta External pointer to a `deflex_delta`, or `NULL` if none.
+ * @param data  User data as for native objective functions (see `createObjective`).
+ * @return The incremental objective function.
+ */
+Delta createDelta (SEXP delta, SEXP data);
+
+
+/**
+ * Marks the partial states of the population unknown.
+ *
+ * @param state The state of the evolution.
+ */
+void forgetPartials (State& state);
+
+
+/**
+ * Evaluates the trial of a candidate, without touching R objects
+ * (hence safe to call from any thread if the functions are).
+ *
+ * @param delta     The incremental objective function.
+ * @param state     The state of the evolution, with the partial state of the trial (output).
+ * @param candidate The candidate.
+ * @param changed   Space for `dimension` indices of changed elements.
+ * @param buffer    Space for `dimension` elements.
+ * @return The trial score.
+ */
+double evaluateDelta (const Delta& delta, State& state, int candidate, int* changed, double* buffer);
+
+
+/**
+ * Evaluates trials with the incremental objective function.
+ *
+ * @param delta    The incremental objective function.
+ * @param state    The state of the evolution, with the trial scores and partial states (output).
+ * @param cache    The cache of scores to consult first and to keep scores in (`NULL` if none).
+ * @param screened Flags of trials screened out, which are not evaluated and keep their scores (`NULL` if none).
+ */
+void evaluateDeltaTrials (const Delta& delta, State& state, Cache* cache, const char* screened);
+
+#endif
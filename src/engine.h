@@ -0,0 +1,813 @@
+#include <cmath>
+#include <algorithm>
+#include "rng.h"
+#include "utils.h"
+#include "population.h"
+#include "kernels.h"
+#include "stats.h"
+#include "strategy.h"
+#include "lattice.h"
+
+#ifndef deflex_engine_h
+#define deflex_engine_h
+
+inline double roundDoubleDownTo(double value, double step) {
+    if (step == 0) {
+        return value;
+    }
+    else {
+        return floor(value / step) * step;
+    }
+}
+
+inline double roundDoubleUpTo(double value, double step) {
+    if (step == 0) {
+        return value;
+    }
+    else {
+        return ceil(value / step) * step;
+    }
+}
+
+inline double roundToClosest (double value, double step) {
+    double down = roundDoubleDownTo(value, step);
+    double up = roundDoubleUpTo(value, step);
+    if (std::abs(value - down) < std::abs(value - up)) {
+        return down;
+    }
+    return up;
+}
+
+
+/**
+ * Provides the problem definition and DE settings which stay the same
+ * during the evolution.
+ */
+struct Problem {
+  /**
+   * Problem dimension.
+   */
+  int dimension;
+
+  /**
+   * Population size.
+   */
+  int popsize;
+
+  /**
+   * Lower-bounds for each parameter.
+   */
+  const double* lower;
+
+  /**
+   * Upper-bounds for each parameter.
+   */
+  const double* upper;
+
+  /**
+   * Crossover probability.
+   */
+  double cr;
+
+  /**
+   * Differential weighting factor.
+   */
+  double f;
+
+  /**
+   * Crossover adaptation speed.
+   */
+  double c;
+
+  /**
+   * Jitter factor.
+   */
+  double jf;
+
+  /**
+   * Mutation scheme.
+   */
+  Mutation mutation;
+
+  /**
+   * Crossover scheme.
+   */
+  Crossover crossover;
+
+  /**
+   * Boundary handling scheme.
+   */
+  Boundary boundary;
+
+  /**
+   * Precision whereby 0 disables it.
+   */
+  double precision;
+
+  /**
+   * Kernels to work on trials with.
+   */
+  const Kernels* kernels;
+
+  /**
+   * Lattice to snap trials to instead of rounding them to the
+   * precision (`NULL` if none).
+   */
+  const Lattice* lattice;
+};
+
+
+/**
+ * Provides the state of an evolution which changes from generation to
+ * generation, along with the buffers to build the next generation in.
+ */
+struct State {
+  /**
+   * Allocates the state.
+   *
+   * @param popsize   Population size.
+   * @param dimension Problem dimension.
+   * @param layout    Storage layout of the population.
+   * @param partial   Number of columns of the partial states of incremental objectives (see `partials`).
+   */
+  State (int popsize, int dimension, Layout layout, int partial = 0)
+    : population(popsize, dimension, layout), nextPopulation(popsize, dimension, layout), scores(popsize), nextScores(popsize),
+      violations(popsize), nextViolations(popsize), partials(popsize, partial, LAYOUT_ROWS), nextPartials(popsize, partial, LAYOUT_ROWS),
+      bestMember(dimension), bestScore(0), meanCR(0), meanF(0), goodCR(0), goodF(0), goodF2(0), goodNPCount(0),
+      trials(popsize, dimension, LAYOUT_ROWS), trialScores(popsize), trialViolations(popsize),
+      trialPartials(popsize, partial, LAYOUT_ROWS), trialCR(popsize), trialF(popsize) {}
+
+  /**
+   * Sets the best member and score as per the population scores.
+   */
+  void findBest () {
+    const int bestIndex = std::min_element(scores.begin(), scores.end()) - scores.begin();
+    bestScore = scores[bestIndex];
+    for (int i = 0; i < population.width(); i++) {
+      bestMember[i] = population(bestIndex, i);
+    }
+  }
+
+  /**
+   * The population and its scores.
+   */
+  Population population;
+
+  /**
+   * The spare population buffer and scores vector to build the next
+   * generation in.
+   */
+  Population nextPopulation;
+  std::vector<double> scores;
+  std::vector<double> nextScores;
+
+  /**
+   * Constraint violations of the population (and of the next
+   * generation) to compare members by before their scores, 0 for
+   * feasible members (see `Constraint`).
+   */
+  std::vector<double> violations;
+  std::vector<double> nextViolations;
+
+  /**
+   * Partial states of the population (and of the next generation) for
+   * incremental objectives, one row per member: the objective score,
+   * `NaN` if the partial state is unknown, followed by the partial
+   * state (no columns if not in use).
+   */
+  Population partials;
+  Population nextPartials;
+
+  /**
+   * The best member and score.
+   */
+  std::vector<double> bestMember;
+  double bestScore;
+
+  /**
+   * Mean crossover probability and differential weighting factor.
+   */
+  double meanCR;
+  double meanF;
+
+  /**
+   * Accumulators of successful crossover probabilities and
+   * differential weighting factors.
+   */
+  double goodCR;
+  double goodF;
+  double goodF2;
+  int goodNPCount;
+
+  /**
+   * The trials (always row-major as trials are built row by row) and
+   * their scores, constraint violations, partial states, CR and F.
+   */
+  Population trials;
+  std::vector<double> trialScores;
+  std::vector<double> trialViolations;
+  Population trialPartials;
+  std::vector<double> trialCR;
+  std::vector<double> trialF;
+};
+
+
+/**
+ * Maximum number of donors a DE strategy picks.
+ */
+const int MAX_DONORS = 5;
+
+
+/**
+ * Number of rows of the scratch space to build a trial in, ie. the
+ * scratch space has `SCRATCH_ROWS * dimension` elements.
+ */
+const int SCRATCH_ROWS = 5 + MAX_DONORS;
+
+
+/**
+ * Picks random donors from the population excluding the candidate.
+ *
+ * For R's random number generator, the donors are the same as the ones
+ * `Rcpp::sample` picks from the vector of candidate indices without the
+ * candidate, yet without building that vector.
+ *
+ * @param rng       Random number generator.
+ * @param popsize   Population size.
+ * @param candidate The candidate to exclude.
+ * @param count     Number of donors, up to `MAX_DONORS`.
+ * @param donors    Donor indices (output).
+ */
+template <typename RNG>
+inline void pickDonors (RNG& rng, int popsize, int candidate, int count, int* donors) {
+  int positions[MAX_DONORS];
+  int values[MAX_DONORS];
+  pickRandom([candidate] (int i) { return i < candidate ? i : i + 1; }, popsize - 1, count,
+             [&rng] (int n) { return rng.index(n); }, donors, positions, values);
+}
+
+
+/**
+ * Computes `base + jitter * (donor1 - donor2)` over a run of elements
+ * which may wrap around the end of the vector.
+ *
+ * @return Number of NaN results reset.
+ */
+inline int mutateRun (const Kernels& kernels, double* mutant, const double* base, const double* donor1, const double* donor2,
+                      const double* jitter, const double* lower, const double* upper, int start, int count, int dimension) {
+  const int head = std::min(count, dimension - start);
+  return kernels.mutate(mutant + start, base + start, donor1 + start, donor2 + start, jitter, lower + start, upper + start, head) +
+    kernels.mutate(mutant, base, donor1, donor2, jitter + head, lower, upper, count - head);
+}
+
+
+/**
+ * Provides the mutation schemes (see `Mutation`). Each computes the
+ * mutant over a run of `count` elements from `start` (wrapping around)
+ * with the jitter of each element in the run, and returns the number of
+ * NaN results reset to the midpoint of the bounds.
+ */
+struct MutationBest1 {
+  static const int DONORS = 2;
+
+  static int mutate (const Kernels& kernels, double* mutant, const double* /*current*/, const double* best, const double* const* donors, double /*f*/,
+                     const double* jitter, const double* lower, const double* upper, int start, int count, int dimension, double* /*work*/) {
+    return mutateRun(kernels, mutant, best, donors[0], donors[1], jitter, lower, upper, start, count, dimension);
+  }
+};
+
+
+struct MutationRand1 {
+  static const int DONORS = 3;
+
+  static int mutate (const Kernels& kernels, double* mutant, const double* /*current*/, const double* /*best*/, const double* const* donors, double /*f*/,
+                     const double* jitter, const double* lower, const double* upper, int start, int count, int dimension, double* /*work*/) {
+    return mutateRun(kernels, mutant, donors[0], donors[1], donors[2], jitter, lower, upper, start, count, dimension);
+  }
+};
+
+
+struct MutationCurrentToBest1 {
+  static const int DONORS = 2;
+
+  static int mutate (const Kernels& kernels, double* mutant, const double* current, const double* best, const double* const* donors, double f,
+                     const double* jitter, const double* lower, const double* upper, int start, int count, int dimension, double* work) {
+    for (int k = 0, i = start; k < count; k++, i = i + 1 < dimension ? i + 1 : 0) {
+      work[i] = current[i] + f * (best[i] - current[i]);
+    }
+    return mutateRun(kernels, mutant, work, donors[0], donors[1], jitter, lower, upper, start, count, dimension);
+  }
+};
+
+
+struct MutationRand2 {
+  static const int DONORS = 5;
+
+  static int mutate (const Kernels& kernels, double* mutant, const double* /*current*/, const double* /*best*/, const double* const* donors, double /*f*/,
+                     const double* jitter, const double* lower, const double* upper, int start, int count, int dimension, double* work) {
+    for (int k = 0, i = start; k < count; k++, i = i + 1 < dimension ? i + 1 : 0) {
+      work[i] = donors[0][i] + jitter[k] * (donors[3][i] - donors[4][i]);
+    }
+    return mutateRun(kernels, mutant, work, donors[1], donors[2], jitter, lower, upper, start, count, dimension);
+  }
+};
+
+
+/**
+ * Provides the crossover schemes (see `Crossover`). Each draws the
+ * jitter of the elements to take from the mutant, and mutates the trial
+ * as per the mutation scheme. It returns the number of NaN results
+ * reset by the mutation.
+ *
+ * The scratch space holds the jitter, uniform random numbers, the work
+ * space of the mutation and the mutant, one row each.
+ */
+struct CrossoverExponential {
+  template <typename Mutate, typename RNG>
+  static int cross (RNG& rng, const Problem& problem, double* trial, const double* current, const double* best, const double* const* donors,
+                    double cr, double f, int start, double* scratch) {
+    const int dimension = problem.dimension;
+
+    // Draw the jitter of each element in the run of elements to modify first:
+    double* jitter = scratch;
+    int k = 0;
+    do {
+      jitter[k] = (rng.unif() * problem.jf) + f;
+      k++;
+    } while (rng.unif() < cr && k < dimension);
+
+    // Override the run in place:
+    return Mutate::mutate(*problem.kernels, trial, current, best, donors, f, jitter, problem.lower, problem.upper, start, k, dimension, scratch + 2 * dimension);
+  }
+};
+
+
+struct CrossoverBinomial {
+  template <typename Mutate, typename RNG>
+  static int cross (RNG& rng, const Problem& problem, double* trial, const double* current, const double* best, const double* const* donors,
+                    double cr, double f, int start, double* scratch) {
+    const int dimension = problem.dimension;
+
+    // Draw the jitter and the uniform random number of each element:
+    double* jitter = scratch;
+    double* uniforms = scratch + dimension;
+    for (int i = 0; i < dimension; i++) {
+      jitter[i] = (rng.unif() * problem.jf) + f;
+      uniforms[i] = rng.unif();
+    }
+
+    // Compute the mutant and take its elements, along with the starting one:
+    double* mutant = scratch + 3 * dimension;
+    const int repairs = Mutate::mutate(*problem.kernels, mutant, current, best, donors, f, jitter, problem.lower, problem.upper, 0, dimension, dimension, scratch + 2 * dimension);
+    problem.kernels->crossover(trial, mutant, uniforms, cr, start, dimension);
+    return repairs;
+  }
+};
+
+
+/**
+ * Provides the boundary handling schemes (see `Boundary`) for elements
+ * of the trial out of bounds.
+ */
+struct BoundaryClamp {
+  template <typename RNG, typename Probe>
+  static void repair (RNG& /*rng*/, const Problem& problem, double* trial, const double* /*current*/, Probe& /*probe*/) {
+    problem.kernels->clamp(trial, problem.lower, problem.upper, problem.dimension);
+  }
+};
+
+
+/**
+ * Bounces back from boundaries, drawing random numbers for violating
+ * elements only. Note that bouncing back from the upper bound lands
+ * below the lower bound, as it always did.
+ */
+struct BoundaryBounceBack {
+  template <typename RNG, typename Probe>
+  static void repair (RNG& rng, const Problem& problem, double* trial, const double* /*current*/, Probe& probe) {
+    const Kernels& kernels = *problem.kernels;
+    const int dimension = problem.dimension;
+    const double* lower = problem.lower;
+    const double* upper = problem.upper;
+    for (int i = kernels.violation(trial, lower, upper, 0, dimension); i < dimension; i = kernels.violation(trial, lower, upper, i + 1, dimension)) {
+      // Check lower limit:
+      if (trial[i] < lower[i]) {
+        trial[i] = lower[i] + rng.unif() * (upper[i] - lower[i]);
+        probe.bounceBack();
+      }
+
+      // Check upper limit:
+      if (trial[i] > upper[i]) {
+        trial[i] = lower[i] - rng.unif() * (upper[i] - lower[i]);
+        probe.bounceBack();
+      }
+    }
+  }
+};
+
+
+struct BoundaryReflect {
+  template <typename RNG, typename Probe>
+  static void repair (RNG& /*rng*/, const Problem& problem, double* trial, const double* /*current*/, Probe& /*probe*/) {
+    const Kernels& kernels = *problem.kernels;
+    const int dimension = problem.dimension;
+    const double* lower = problem.lower;
+    const double* upper = problem.upper;
+    for (int i = kernels.violation(trial, lower, upper, 0, dimension); i < dimension; i = kernels.violation(trial, lower, upper, i + 1, dimension)) {
+      trial[i] = trial[i] < lower[i] ? 2 * lower[i] - trial[i] : 2 * upper[i] - trial[i];
+      trial[i] = std::min(std::max(trial[i], lower[i]), upper[i]);
+    }
+  }
+};
+
+
+struct BoundaryMidpoint {
+  template <typename RNG, typename Probe>
+  static void repair (RNG& /*rng*/, const Problem& problem, double* trial, const double* current, Probe& /*probe*/) {
+    const Kernels& kernels = *problem.kernels;
+    const int dimension = problem.dimension;
+    const double* lower = problem.lower;
+    const double* upper = problem.upper;
+    for (int i = kernels.violation(trial, lower, upper, 0, dimension); i < dimension; i = kernels.violation(trial, lower, upper, i + 1, dimension)) {
+      trial[i] = trial[i] < lower[i] ? (lower[i] + current[i]) / 2.0 : (upper[i] + current[i]) / 2.0;
+    }
+  }
+};
+
+
+/**
+ * Provides the CR and F adaptation schemes, ie. none, which keeps the
+ * given CR and F, and the JADE-like one, which draws them around the
+ * means adapted with the crossover adaptation speed.
+ */
+struct AdaptationNone {
+  template <typename RNG>
+  static void draw (RNG& /*rng*/, const Problem& problem, double /*meanCR*/, double /*meanF*/, double& cr, double& f) {
+    cr = problem.cr;
+    f = problem.f;
+  }
+};
+
+
+struct AdaptationJade {
+  template <typename RNG>
+  static void draw (RNG& rng, const Problem& /*problem*/, double meanCR, double meanF, double& cr, double& f) {
+    // We will now adjust the CR first:
+    cr = rng.norm(meanCR, 0.1);
+
+    // Check and reset CR:
+    cr = cr > 1 ? 1 : (cr < 0 ? 0 : cr);
+
+    // OK, now we will adjust F:
+    do {
+      // Get the new F:
+      f = rng.cauchy(meanF, 0.1);
+
+      // Check and reset F if required:
+      f = f > 1 ? 1 : f;
+    } while (f <= 0.0);
+  }
+};
+
+
+/**
+ * Builds the trial for a candidate with the given mutation, crossover,
+ * boundary handling and adaptation schemes.
+ *
+ * @param rng        Random number generator.
+ * @param problem    Problem definition and DE settings.
+ * @param meanCR     Current mean crossover probability.
+ * @param meanF      Current mean differential weighting factor.
+ * @param population Last population.
+ * @param bestMember Best member of the last population.
+ * @param candidate  The candidate index.
+ * @param trial      The trial (output).
+ * @param cr         Crossover probability used for the trial (output).
+ * @param f          Differential weighting factor used for the trial (output).
+ * @param scratch    Scratch space of `SCRATCH_ROWS * dimension` elements.
+ * @param probe      Probe to time phases and count events with (see `Stats`).
+ */
+template <typename Mutate, typename Cross, typename Repair, typename Adapt, typename RNG, typename Probe>
+inline void buildTrial (RNG& rng,
+                        const Problem& problem,
+                        double meanCR,
+                        double meanF,
+                        const Population& population,
+                        const double* bestMember,
+                        int candidate,
+                        double* trial,
+                        double& cr,
+                        double& f,
+                        double* scratch,
+                        Probe& probe) {
+  // Start timing:
+  typename Probe::Mark mark = probe.mark();
+
+  // Get the problem dimension and population size:
+  const int dimension = problem.dimension;
+  const int popsize = population.size();
+
+  //     1. Adjust CR and F if adaptation speed is in use.
+  Adapt::draw(rng, problem, meanCR, meanF, cr, f);
+  probe.lap(PHASE_ADAPTATION, mark);
+
+  //     2. Copy the trial from the current candidate.
+  const double* current = population.row(candidate, scratch + 4 * dimension);
+  std::copy(current, current + dimension, trial);
+
+  //     3. Pick random candidates from the last population (ideally excluding the current candidate).
+  int ridx[MAX_DONORS];
+  const double* donors[MAX_DONORS];
+  pickDonors(rng, popsize, candidate, Mutate::DONORS, ridx);
+  for (int i = 0; i < Mutate::DONORS; i++) {
+    donors[i] = population.row(ridx[i], scratch + (5 + i) * dimension);
+  }
+
+  //     4. Pick which element to start with for the trial.
+  const int j = rng.index(dimension);
+  probe.lap(PHASE_DONORS, mark);
+
+  //     5. Modify the elements of the trial as per the crossover and mutation schemes (Actual work)
+  probe.nanRepairs(Cross::template cross<Mutate>(rng, problem, trial, current, bestMember, donors, cr, f, j, scratch));
+  probe.lap(PHASE_MUTATION, mark);
+
+  //     6. Apply precision to each element in the trial, if "precision adjustment" is in use (but on a lattice).
+  if (problem.precision != 0 && problem.lattice == NULL) {
+    problem.kernels->round(trial, problem.precision, dimension);
+  }
+
+  //     7. Apply limits to each element in the trial, in case that we have violated.
+  probe.bounds(trial, problem.lower, problem.upper, dimension);
+  Repair::repair(rng, problem, trial, current, probe);
+
+  //     8. Snap the trial to the lattice, if in use, which keeps it within bounds.
+  if (problem.lattice != NULL) {
+    problem.lattice->snap(trial);
+  }
+  probe.lap(PHASE_REPAIR, mark);
+}
+
+
+/**
+ * Provides the trial builder of a fully specialised strategy (see
+ * `buildTrial`).
+ */
+template <typename Probe>
+using TrialBuilder = void (*) (Random&, const Problem&, double, double, const Population&, const double*, int, double*, double&, double&, double*, Probe&);
+
+
+/**
+ * Selects the trial builder specialised for the adaptation scheme.
+ */
+template <typename Probe, typename Mutate, typename Cross, typename Repair>
+inline TrialBuilder<Probe> selectAdaptation (const Problem& problem) {
+  if (problem.c > 0) {
+    return &buildTrial<Mutate, Cross, Repair, AdaptationJade, Random, Probe>;
+  }
+  return &buildTrial<Mutate, Cross, Repair, AdaptationNone, Random, Probe>;
+}
+
+
+/**
+ * Selects the trial builder specialised for the boundary handling and
+ * adaptation schemes.
+ */
+template <typename Probe, typename Mutate, typename Cross>
+inline TrialBuilder<Probe> selectBoundary (const Problem& problem) {
+  switch (problem.boundary) {
+  case BOUNDARY_BOUNCE_BACK:
+    return selectAdaptation<Probe, Mutate, Cross, BoundaryBounceBack>(problem);
+  case BOUNDARY_REFLECT:
+    return selectAdaptation<Probe, Mutate, Cross, BoundaryReflect>(problem);
+  case BOUNDARY_MIDPOINT:
+    return selectAdaptation<Probe, Mutate, Cross, BoundaryMidpoint>(problem);
+  default:
+    return selectAdaptation<Probe, Mutate, Cross, BoundaryClamp>(problem);
+  }
+}
+
+
+/**
+ * Selects the trial builder specialised for the crossover, boundary
+ * handling and adaptation schemes.
+ */
+template <typename Probe, typename Mutate>
+inline TrialBuilder<Probe> selectCrossover (const Problem& problem) {
+  if (problem.crossover == CROSSOVER_BINOMIAL) {
+    return selectBoundary<Probe, Mutate, CrossoverBinomial>(problem);
+  }
+  return selectBoundary<Probe, Mutate, CrossoverExponential>(problem);
+}
+
+
+/**
+ * Selects the trial builder specialised for the strategy of the
+ * problem, once before the evolution, so that building trials does not
+ * branch on the strategy.
+ *
+ * @param problem Problem definition and DE settings.
+ * @return The trial builder.
+ */
+template <typename Probe>
+inline TrialBuilder<Probe> selectBuilder (const Problem& problem) {
+  switch (problem.mutation) {
+  case MUTATION_RAND1:
+    return selectCrossover<Probe, MutationRand1>(problem);
+  case MUTATION_CURRENT_TO_BEST1:
+    return selectCrossover<Probe, MutationCurrentToBest1>(problem);
+  case MUTATION_RAND2:
+    return selectCrossover<Probe, MutationRand2>(problem);
+  default:
+    return selectCrossover<Probe, MutationBest1>(problem);
+  }
+}
+
+
+/**
+ * Builds the trials of a range of candidates.
+ *
+ * @param build   The trial builder (see `selectBuilder`).
+ * @param rng     Random number generator.
+ * @param problem Problem definition and DE settings.
+ * @param state   The state of the evolution.
+ * @param from    The first candidate (inclusive).
+ * @param to      The last candidate (exclusive).
+ * @param scratch Scratch space of `SCRATCH_ROWS * dimension` elements.
+ * @param probe   Probe to time phases and count events with (see `Stats`).
+ */
+template <typename Probe>
+inline void buildTrials (TrialBuilder<Probe> build, Random& rng, const Problem& problem, State& state, int from, int to, double* scratch, Probe& probe) {
+  for (int candidate = from; candidate < to; candidate++) {
+    build(rng, problem, state.meanCR, state.meanF, state.population, state.bestMember.data(), candidate,
+          state.trials.row(candidate), state.trialCR[candidate], state.trialF[candidate], scratch, probe);
+  }
+}
+
+
+/**
+ * Builds the trials of a range of candidates without instrumentation.
+ */
+inline void buildTrials (TrialBuilder<NoStats> build, Random& rng, const Problem& problem, State& state, int from, int to, double* scratch) {
+  NoStats probe;
+  buildTrials(build, rng, problem, state, from, to, scratch, probe);
+}
+
+
+/**
+ * Accumulates the CR and F of a trial which improved on its candidate.
+ *
+ * @param state     The state of the evolution.
+ * @param candidate The candidate.
+ */
+inline void recordSuccess (State& state, int candidate) {
+  state.goodCR += state.trialCR[candidate] / ++state.goodNPCount;
+  state.goodF += state.trialF[candidate];
+  state.goodF2 += std::pow(state.trialF[candidate], 2);
+}
+
+
+/**
+ * Re-computes mean CR and F from the successful ones if adaptation
+ * speed is in use.
+ *
+ * @param problem Problem definition and DE settings.
+ * @param state   The state of the evolution.
+ */
+inline void adaptParameters (const Problem& problem, State& state) {
+  if (problem.c > 0 && state.goodF != 0) {
+    state.meanCR = (1.0 - problem.c) * state.meanCR + problem.c * state.goodCR;
+    state.meanF  = (1.0 - problem.c) * state.meanF  + problem.c * state.goodF2 / state.goodF;
+  }
+}
+
+
+/**
+ * Selects the next generation among the population and the evaluated
+ * trials, and swaps it in.
+ *
+ * @param problem Problem definition and DE settings.
+ * @param state   The state of the evolution.
+ * @return Number of trials which replaced their candidates.
+ */
+inline int selectTrials (const Problem& problem, State& state) {
+  // Get the current best member from the last population:
+  int newBestIndex = -1;
+  int replacements = 0;
+
+  // Get the population size, and check if we carry partial states:
+  const int popsize = state.population.size();
+  const bool partial = state.partials.width() > 0;
+
+  // Assess each trial and take actions:
+  //     1. If trial is not better than the previous candidate, ie. neither less violating the constraints nor
+  //        scoring better with the same violation, keep the new population candidate same as last population
+  //        candidate, and mark the new population candidate index as "unchanged".
+  //     2. Otherwise:
+  //         1. Set the new population candidate to trial.
+  //         2. Update the new population candidate score and violation.
+  //         2. Update goodCR, goodF and goodF2 if adaptation speed is in use.
+  for (int candidate = 0; candidate < popsize; candidate++) {
+    const double trialScore = state.trialScores[candidate];
+    const double trialViolation = state.trialViolations[candidate];
+
+    if (trialViolation < state.violations[candidate] || (trialViolation == state.violations[candidate] && trialScore < state.scores[candidate])) {
+      state.nextPopulation.assign(candidate, state.trials.row(candidate));
+      state.nextScores[candidate] = trialScore;
+      state.nextViolations[candidate] = trialViolation;
+      if (partial) {
+        state.nextPartials.assign(candidate, state.trialPartials.row(candidate));
+      }
+
+      recordSuccess(state, candidate);
+      replacements++;
+
+      if (trialScore < state.bestScore) {
+        state.bestScore = trialScore;
+        newBestIndex = candidate;
+      }
+    }
+    else {
+      state.nextPopulation.assign(candidate, state.population, candidate);
+      state.nextScores[candidate] = state.scores[candidate];
+      state.nextViolations[candidate] = state.violations[candidate];
+      if (partial) {
+        state.nextPartials.assign(candidate, state.partials, candidate);
+      }
+    }
+  }
+
+  // Re-compute mean CR and F if required:
+  adaptParameters(problem, state);
+
+  // Swap buffers:
+  state.population.swap(state.nextPopulation);
+  state.scores.swap(state.nextScores);
+  state.violations.swap(state.nextViolations);
+  state.partials.swap(state.nextPartials);
+
+  // Update the best member:
+  if (newBestIndex >= 0) {
+    const double* trial = state.trials.row(newBestIndex);
+    std::copy(trial, trial + state.population.width(), state.bestMember.begin());
+  }
+
+  // Done, return:
+  return replacements;
+}
+
+
+/**
+ * Shrinks the population by dropping its worst members.
+ *
+ * The members kept stay in their order and are compacted to the top
+ * of the population in place. Buffers of the next generation and of
+ * the trials are shrunk along, without reallocation.
+ *
+ * @param state The state of the evolution.
+ * @param size  New population size, at most the current one.
+ */
+inline void reducePopulation (State& state, int size) {
+  // Get the population size:
+  const int popsize = state.population.size();
+  if (size >= popsize) {
+    return;
+  }
+
+  // Rank members by their constraint violations and scores, and keep the best ones in their order:
+  std::vector<int> ranks(popsize);
+  for (int i = 0; i < popsize; i++) {
+    ranks[i] = i;
+  }
+  std::stable_sort(ranks.begin(), ranks.end(), [&state] (int a, int b) {
+    return state.violations[a] < state.violations[b] || (state.violations[a] == state.violations[b] && state.scores[a] < state.scores[b]);
+  });
+  std::sort(ranks.begin(), ranks.begin() + size);
+
+  // Compact the members kept (each moves up, if at all):
+  for (int i = 0; i < size; i++) {
+    if (ranks[i] != i) {
+      state.population.assign(i, state.population, ranks[i]);
+      state.scores[i] = state.scores[ranks[i]];
+      state.violations[i] = state.violations[ranks[i]];
+      state.partials.assign(i, state.partials, ranks[i]);
+    }
+  }
+
+  // Shrink the population and the buffers:
+  state.population.resize(size);
+  state.nextPopulation.resize(size);
+  state.trials.resize(size);
+  state.scores.resize(size);
+  state.nextScores.resize(size);
+  state.violations.resize(size);
+  state.nextViolations.resize(size);
+  state.partials.resize(size);
+  state.nextPartials.resize(size);
+  state.trialScores.resize(size);
+  state.trialViolations.resize(size);
+  state.trialPartials.resize(size);
+  state.trialCR.resize(size);
+  state.trialF.resize(size);
+}
+
+#endif
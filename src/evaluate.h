@@ -1,32 +1,207 @@
+#include <vector>
 #include <Rcpp.h>
+#include "deflex.h"
+#include "population.h"
+#include "cache.h"
+#include "processpool.h"
 
 #ifndef deflex_evaluate_h
 #define deflex_evaluate_h
 
+/**
+ * Provides the objective function to be evaluated, either an R
+ * function or a native function.
+ */
+struct Objective {
+  /**
+   * The R function (`R_NilValue` for native objective functions).
+   */
+  SEXP function;
+
+  /**
+   * The native function (`NULL` for R objective functions).
+   */
+  deflex_objective native;
+
+  /**
+   * User data passed to the native function.
+   */
+  void* data;
+
+  /**
+   * Whether the R function is called in batch mode.
+   */
+  bool batch;
+
+  /**
+   * Tolerance of the bounds check of candidates before evaluation.
+   */
+  double tolerance;
+};
+
+/**
+ * Creates the objective from an R function or an external pointer to
+ * a native function.
+ *
+ * If `data` is an external pointer, its address is passed to the
+ * native function as user data. Otherwise, the R object itself is
+ * passed unless it is `NULL`.
+ *
+ * @param objective R function or external pointer to a `deflex_objective`.
+ * @param data User data for the native function.
+ * @param batch Whether the R function is called in batch mode.
+ * @param tolerance Tolerance of the bounds check of candidates.
+ * @return The objective.
+ */
+inline Objective createObjective (SEXP objective, SEXP data, bool batch, double tolerance = 1e-8) {
+  // Declare the return value:
+  Objective retval;
+  retval.function = R_NilValue;
+  retval.native = NULL;
+  retval.data = NULL;
+  retval.batch = batch;
+  retval.tolerance = tolerance;
+
+  // Check if we have an R function:
+  if (Rf_isFunction(objective)) {
+    retval.function = objective;
+    return retval;
+  }
+
+  // We need an external pointer to the native function now:
+  if (TYPEOF(objective) != EXTPTRSXP) {
+    Rcpp::stop("Objective must be an R function or an external pointer to a native function.");
+  }
+
+  // Get the native function:
+  deflex_objective* native = static_cast<deflex_objective*>(R_ExternalPtrAddr(objective));
+  if (native == NULL || *native == NULL) {
+    Rcpp::stop("Native objective function pointer is NULL.");
+  }
+  retval.native = *native;
+
+  // Get the user data:
+  if (TYPEOF(data) == EXTPTRSXP) {
+    retval.data = R_ExternalPtrAddr(data);
+  }
+  else if (!Rf_isNull(data)) {
+    retval.data = data;
+  }
+
+  // Done, return:
+  return retval;
+}
+
 /**
  * Evaluates fcall on par within env.
  *
+ * R errors are caught and rethrown as C++ exceptions, so that the stack
+ * unwinds and destructors (thread pools, worker processes, files) run.
+ *
  * @param par Parameter vector to fcall.
  * @param fcall R function to evaluate.
  * @param env Environment to evaluate within.
  * @return Value the evaluation yields
  */
-double evaluate (SEXP par, SEXP fcall, SEXP env) {
-  SEXP sexp_fvec, fn;
-  double f_result;
+inline double evaluate (SEXP par, SEXP fcall, SEXP env) {
+  Rcpp::Shield<SEXP> fn(Rf_lang2(fcall, par));
+  Rcpp::Shield<SEXP> sexp_fvec(Rcpp::Rcpp_eval(fn, env));
+  const double f_result = REAL(sexp_fvec)[0];
+
+  if(ISNAN(f_result)) {
+    Rcpp::stop("NaN value of objective function! \nPerhaps adjust the bounds.");
+  }
+
+  return(f_result);
+}
 
-  PROTECT(fn = Rf_lang2(fcall, par));
-  PROTECT(sexp_fvec = Rf_eval(fn, env));
-  f_result = REAL(sexp_fvec)[0];
+/**
+ * Evaluates the native objective function on par.
+ *
+ * @param par Parameter vector.
+ * @param size Number of parameters.
+ * @param objective Objective with the native function.
+ * @return Value the evaluation yields
+ */
+inline double evaluateNative (const double* par, int size, const Objective& objective) {
+  const double f_result = objective.native(par, size, objective.data);
 
   if(ISNAN(f_result)) {
-    Rf_error("NaN value of objective function! \nPerhaps adjust the bounds.");
+    Rcpp::stop("NaN value of objective function! \nPerhaps adjust the bounds.");
   }
 
-  UNPROTECT(2);
   return(f_result);
 }
 
+/**
+ * Evaluates fcall on the rows of population within env in one call.
+ *
+ * @param population Matrix of parameter vectors (one per row) to fcall.
+ * @param fcall R function to evaluate.
+ * @param env Environment to evaluate within.
+ * @return Values the evaluation yields, one per row.
+ */
+inline Rcpp::NumericVector evaluateBatch (const Rcpp::NumericMatrix population, SEXP fcall, SEXP env) {
+  Rcpp::Shield<SEXP> fn(Rf_lang2(fcall, population));
+  Rcpp::NumericVector f_result(Rcpp::Rcpp_eval(fn, env));
+
+  if (f_result.size() != population.nrow()) {
+    Rcpp::stop("Batch objective function must return one score per row.");
+  }
+
+  for (int i = 0; i < f_result.size(); i++) {
+    if(ISNAN(f_result[i])) {
+      Rcpp::stop("NaN value of objective function! \nPerhaps adjust the bounds.");
+    }
+  }
+
+  return(f_result);
+}
+
+/**
+ * Checks if the candidate is within the boundaries, without touching
+ * R objects (hence safe to call from any thread).
+ *
+ * @param candidate The candidate.
+ * @param lower Lower-bounds.
+ * @param upper Upper-bounds.
+ * @param dimension Number of elements.
+ * @param tolerance Tolerance to allow beyond the boundaries.
+ * @return True if the candidate is within boundaries, false otherwise.
+ */
+inline bool isFeasible (const double* candidate, const double* lower, const double* upper, int dimension, double tolerance) {
+  // Iterate over candidate elements and make sure that we are between
+  // boundaries:
+  for (int i = 0; i < dimension; i++) {
+    // Get the element:
+    const double element = candidate[i];
+
+    // Check the element against lower and upper boundaries, with the tolerance:
+    if ((element + tolerance) < lower[i] || (element - tolerance) > upper[i]) {
+      return false;
+    }
+  }
+
+  // Done, we are within boundaries:
+  return true;
+}
+
+/**
+ * Checks if the candidate is within the boundaries.
+ *
+ * @param candidate The candidate.
+ * @param lower Lower-bounds.
+ * @param upper Upper-bounds.
+ * @param tolerance Tolerance to allow beyond the boundaries.
+ * @return True if the candidate is within boundaries, false otherwise.
+ */
+inline bool isFeasible (const Rcpp::NumericVector candidate,
+                        const Rcpp::NumericVector lower,
+                        const Rcpp::NumericVector upper,
+                        double tolerance) {
+  return isFeasible(candidate.begin(), lower.begin(), upper.begin(), candidate.size(), tolerance);
+}
+
 /**
  * An auxiliary function to evaluate the objective score over the
  * provided candidate.
@@ -36,48 +211,196 @@ double evaluate (SEXP par, SEXP fcall, SEXP env) {
  * @return The objective score.
  */
 inline double evaluateObjective (const Rcpp::NumericVector candidate,
-                                 const Rcpp::Function objective,
+                                 const Objective& objective,
                                  const Rcpp::NumericVector lower,
                                  const Rcpp::NumericVector upper) {
-  // Iterate over candidate elements and make sure that we are between
-  // boundaries:
-  for (int i = 0; i < candidate.size(); i++) {
-    // Get the element:
-    const double element = candidate[i];
-
-    // Check the element against lower and upper boundaries:
-    // TODO: DANGER! We are giving a tolerance to check the value against the limits.
-    if ((element + 0.00000001) < lower[i] || (element - 0.00000001) > upper[i]) {
-      return std::numeric_limits<double>::infinity();
-    }
+  // Make sure that we are between boundaries:
+  if (!isFeasible(candidate, lower, upper, objective.tolerance)) {
+    return std::numeric_limits<double>::infinity();
   }
 
   // Done, return the objective function score:
-  return Rcpp::as<double>(objective(candidate));
+  if (objective.native != NULL) {
+    return evaluateNative(candidate.begin(), candidate.size(), objective);
+  }
+  return Rcpp::as<double>(Rcpp::Function(objective.function)(candidate));
 }
 
 /**
  * An auxiliary function to evaluate the objective score over
  * population.
  *
+ * In batch mode, the objective function is called once with the
+ * matrix of feasible candidates and is expected to return a vector of
+ * scores.
+ *
  * @param objective  The objective function.
  * @param population The population.
+ * @param cache      The cache of scores to consult first and to keep scores in (`NULL` if none).
+ * @param screened   Flags of candidates screened out, which are not evaluated and score 0 (`NULL` if none).
  * @return The objective scores.
  */
 inline Rcpp::NumericVector evaluateObjectives (const Rcpp::NumericMatrix population,
-                                               const Rcpp::Function objective,
+                                               const Objective& objective,
                                                const Rcpp::NumericVector lower,
-                                               const Rcpp::NumericVector upper) {
+                                               const Rcpp::NumericVector upper,
+                                               Cache* cache = NULL,
+                                               const char* screened = NULL) {
   // Create a vector of scores:
   Rcpp::NumericVector scores(population.nrow());
 
-  // Iterate over the population and calculate scores:
+  // Create the candidate buffer for the cache:
+  std::vector<double> buffer(population.ncol());
+
+  // Find candidates to evaluate, ie. the ones neither screened out nor in the cache:
+  std::vector<int> pending;
   for (int i = 0; i < population.nrow(); i++) {
-    scores[i] = evaluateObjective(population.row(i), objective, lower, upper);
+    if (screened != NULL && screened[i]) {
+      continue;
+    }
+    if (cache != NULL) {
+      for (int j = 0; j < population.ncol(); j++) {
+        buffer[j] = population(i, j);
+      }
+      if (cache->find(buffer.data(), scores[i])) {
+        continue;
+      }
+    }
+    pending.push_back(i);
+  }
+  const int count = pending.size();
+
+  // Check if we are in batch mode:
+  if (!objective.batch || objective.native != NULL) {
+    // Iterate over the population and calculate scores:
+    for (int k = 0; k < count; k++) {
+      scores[pending[k]] = evaluateObjective(population.row(pending[k]), objective, lower, upper);
+    }
+  }
+  else {
+    // Find feasible candidates, infeasible ones get an infinite score:
+    std::vector<int> feasible;
+    for (int k = 0; k < count; k++) {
+      if (isFeasible(population.row(pending[k]), lower, upper, objective.tolerance)) {
+        feasible.push_back(pending[k]);
+      }
+      else {
+        scores[pending[k]] = std::numeric_limits<double>::infinity();
+      }
+    }
+
+    // Collect feasible candidates and evaluate them in one call, if any:
+    if (!feasible.empty()) {
+      Rcpp::NumericMatrix candidates(feasible.size(), population.ncol());
+      for (size_t i = 0; i < feasible.size(); i++) {
+        candidates(i, Rcpp::_) = population.row(feasible[i]);
+      }
+      Rcpp::NumericVector feasibleScores = evaluateBatch(candidates, objective.function, R_GlobalEnv);
+
+      // Put scores back in place:
+      for (size_t i = 0; i < feasible.size(); i++) {
+        scores[feasible[i]] = feasibleScores[i];
+      }
+    }
+  }
+
+  // Keep the scores in the cache:
+  if (cache != NULL) {
+    for (int k = 0; k < count; k++) {
+      for (int j = 0; j < population.ncol(); j++) {
+        buffer[j] = population(pending[k], j);
+      }
+      cache->insert(buffer.data(), scores[pending[k]]);
+    }
   }
 
   // Done, return scores:
   return scores;
 }
 
+/**
+ * Evaluates the objective function over trials.
+ *
+ * Native objective functions are called for each trial without any
+ * allocation on the R side. R objective functions are called for each
+ * trial, or once for all trials in batch mode, either in the session or
+ * on worker processes. Trials found in the cache are not evaluated.
+ *
+ * @param trials    Trials.
+ * @param objective The objective function.
+ * @param env       Environment to evaluate R objective functions within.
+ * @param cache     The cache of scores to consult first and to keep scores in (`NULL` if none).
+ * @param scores    The trial scores (output).
+ * @param screened  Flags of trials screened out, which are not evaluated and keep their scores (`NULL` if none).
+ * @param processes Worker processes to evaluate R objective functions on (`NULL` if none).
+ */
+inline void evaluateTrials (const Population& trials, const Objective& objective, SEXP env, Cache* cache, std::vector<double>& scores,
+                            const char* screened = NULL, ProcessPool* processes = NULL) {
+  // Create the trial buffer:
+  std::vector<double> buffer(trials.width());
+
+  // Find trials to evaluate, ie. the ones neither screened out nor in the cache:
+  std::vector<int> pending;
+  for (int i = 0; i < trials.size(); i++) {
+    if (screened != NULL && screened[i]) {
+      continue;
+    }
+    if (cache == NULL || !cache->find(trials.row(i, buffer.data()), scores[i])) {
+      pending.push_back(i);
+    }
+  }
+  const int count = pending.size();
+
+  // Check if we have a native objective function:
+  if (objective.native != NULL) {
+    // Iterate over trials and calculate scores:
+    for (int k = 0; k < count; k++) {
+      scores[pending[k]] = evaluateNative(trials.row(pending[k], buffer.data()), trials.width(), objective);
+    }
+  }
+
+  // Check if we evaluate on worker processes:
+  else if (processes != NULL) {
+    processes->evaluate(trials, pending, scores);
+  }
+
+  // Check if we are in batch mode:
+  else if (objective.batch) {
+    // Convert trials to an R matrix and evaluate in one go:
+    if (!pending.empty()) {
+      Rcpp::NumericMatrix matrix(pending.size(), trials.width());
+      if (count == trials.size()) {
+        trials.write(matrix.begin());
+      }
+      else {
+        for (int k = 0; k < count; k++) {
+          for (int j = 0; j < trials.width(); j++) {
+            matrix(k, j) = trials(pending[k], j);
+          }
+        }
+      }
+      Rcpp::NumericVector batchScores = evaluateBatch(matrix, objective.function, env);
+      for (int k = 0; k < count; k++) {
+        scores[pending[k]] = batchScores[k];
+      }
+    }
+  }
+
+  // Iterate over trials and calculate scores:
+  else {
+    for (int k = 0; k < count; k++) {
+      const double* row = trials.row(pending[k], buffer.data());
+      Rcpp::NumericVector trial(row, row + trials.width());
+      scores[pending[k]] = evaluate(trial, objective.function, env);
+    }
+  }
+
+  // Keep the scores in the cache:
+  if (cache != NULL) {
+    for (int k = 0; k < count; k++) {
+      cache->insert(trials.row(pending[k], buffer.data()), scores[pending[k]]);
+    }
+  }
+}
+
 #endif
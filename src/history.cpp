@@ -0,0 +1,250 @@
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+#include "history.h"
+
+Retention parseRetention (const std::string& name) {
+  if (name == "all") {
+    return RETAIN_ALL;
+  }
+  else if (name == "final") {
+    return RETAIN_FINAL;
+  }
+  else if (name == "every") {
+    return RETAIN_EVERY;
+  }
+  else if (name == "best") {
+    return RETAIN_BEST;
+  }
+  else if (name == "last") {
+    return RETAIN_LAST;
+  }
+  Rcpp::stop("Unknown history retention policy: " + name);
+}
+
+
+History::History (Retention policy, int every, int size, int dimension)
+  : policy(policy), every(every), size(size), dimension(dimension), last(-1), head(0) {
+  // Check the settings:
+  if (policy == RETAIN_EVERY && every < 1) {
+    Rcpp::stop("History interval must be a positive number.");
+  }
+  if (policy == RETAIN_LAST && size < 1) {
+    Rcpp::stop("History size must be a positive number.");
+  }
+}
+
+
+void History::record (int generation,
+                      const Population& population,
+                      const std::vector<double>& scores,
+                      const std::vector<double>& bestMember,
+                      double bestScore) {
+  switch (policy) {
+  case RETAIN_ALL:
+  case RETAIN_LAST:
+    keepPopulation(generation, population, scores);
+    keepBest(bestMember, bestScore);
+    break;
+  case RETAIN_EVERY:
+    if (generation % every == 0) {
+      keepPopulation(generation, population, scores);
+      keepBest(bestMember, bestScore);
+    }
+    break;
+  case RETAIN_BEST:
+    keepBest(bestMember, bestScore);
+    break;
+  case RETAIN_FINAL:
+    break;
+  }
+}
+
+
+void History::finish (int generation,
+                      const Population& population,
+                      const std::vector<double>& scores,
+                      const std::vector<double>& bestMember,
+                      double bestScore) {
+  // Nothing to do if we have already recorded the final generation:
+  if (last == generation) {
+    return;
+  }
+
+  // Keep the population and scores, and the best member unless the best trajectory is already kept:
+  keepPopulation(generation, population, scores);
+  if (policy != RETAIN_BEST) {
+    keepBest(bestMember, bestScore);
+  }
+}
+
+
+void History::keepPopulation (int generation, const Population& population, const std::vector<double>& scores) {
+  // Remember the last generation we have kept:
+  last = generation;
+
+  // Check if we are using the ring buffer and it is full:
+  if (policy == RETAIN_LAST && generationSlots.size() == static_cast<size_t>(size)) {
+    // Re-allocate the oldest slot if the population has shrunk since:
+    if (populationSlots[head].nrow() != population.size()) {
+      populationSlots[head] = Rcpp::NumericMatrix(population.size(), dimension);
+      scoreSlots[head] = Rcpp::NumericVector(population.size());
+    }
+
+    // Overwrite the oldest slot in place:
+    population.write(populationSlots[head].begin());
+    std::copy(scores.begin(), scores.end(), scoreSlots[head].begin());
+    generationSlots[head] = generation;
+    return;
+  }
+
+  // Append copies:
+  Rcpp::NumericMatrix matrix(population.size(), dimension);
+  population.write(matrix.begin());
+  populationSlots.push_back(matrix);
+  scoreSlots.push_back(Rcpp::NumericVector(scores.begin(), scores.end()));
+  generationSlots.push_back(generation);
+}
+
+
+void History::keepBest (const std::vector<double>& bestMember, double bestScore) {
+  // Check if we are using the ring buffer and it is full:
+  if (policy == RETAIN_LAST && bestScoreSlots.size() == static_cast<size_t>(size)) {
+    // Overwrite the oldest slot in place and advance the head:
+    std::copy(bestMember.begin(), bestMember.end(), bestMemberSlots[head].begin());
+    bestScoreSlots[head] = bestScore;
+    head = (head + 1) % size;
+    return;
+  }
+
+  // Append copies:
+  bestMemberSlots.push_back(Rcpp::NumericVector(bestMember.begin(), bestMember.end()));
+  bestScoreSlots.push_back(bestScore);
+}
+
+
+int History::position (int i) const {
+  return policy == RETAIN_LAST ? (head + i) % generationSlots.size() : i;
+}
+
+
+Rcpp::List History::populations () const {
+  Rcpp::List retval(populationSlots.size());
+  for (size_t i = 0; i < populationSlots.size(); i++) {
+    retval[i] = populationSlots[position(i)];
+  }
+  return retval;
+}
+
+
+Rcpp::List History::scores () const {
+  Rcpp::List retval(scoreSlots.size());
+  for (size_t i = 0; i < scoreSlots.size(); i++) {
+    retval[i] = scoreSlots[position(i)];
+  }
+  return retval;
+}
+
+
+Rcpp::List History::bestMembers () const {
+  Rcpp::List retval(bestMemberSlots.size());
+  for (size_t i = 0; i < bestMemberSlots.size(); i++) {
+    retval[i] = bestMemberSlots[position(i)];
+  }
+  return retval;
+}
+
+
+Rcpp::List History::bestScores () const {
+  Rcpp::List retval(bestScoreSlots.size());
+  for (size_t i = 0; i < bestScoreSlots.size(); i++) {
+    retval[i] = bestScoreSlots[position(i)];
+  }
+  return retval;
+}
+
+
+Rcpp::IntegerVector History::generations () const {
+  Rcpp::IntegerVector retval(generationSlots.size());
+  for (size_t i = 0; i < generationSlots.size(); i++) {
+    retval[i] = generationSlots[position(i)];
+  }
+  return retval;
+}
+
+
+HistoryFile::HistoryFile (const std::string& path, int popsize, int dimension)
+  : file(NULL), buffer(1 << 20), matrix(static_cast<size_t>(popsize) * dimension), padding(popsize, NAN), popsize(popsize), dimension(dimension), count(0) {
+  // Open the file:
+  file = std::fopen(path.c_str(), "wb");
+  if (file == NULL) {
+    Rcpp::stop("Can not open history file for writing: " + path);
+  }
+
+  // Use a large buffer as we are writing whole generations at once:
+  std::setvbuf(file, buffer.data(), _IOFBF, buffer.size());
+
+  // Write the header:
+  char header[64] = { 'D', 'E', 'F', 'L', 'E', 'X', 'H', 0 };
+  const int32_t fields[4] = { 1, dimension, popsize, 0 };
+  std::memcpy(header + 8, fields, sizeof(fields));
+  std::memcpy(header + 24, &count, sizeof(count));
+  write(header, 1, sizeof(header));
+}
+
+
+HistoryFile::~HistoryFile () {
+  // Make sure that the file is closed without throwing:
+  if (file != NULL) {
+    std::fclose(file);
+  }
+}
+
+
+void HistoryFile::append (int generation,
+                          const Population& population,
+                          const std::vector<double>& scores,
+                          const std::vector<double>& bestMember,
+                          double bestScore,
+                          double meanCR,
+                          double meanF) {
+  const double fields[4] = { static_cast<double>(generation), bestScore, meanCR, meanF };
+  write(fields, sizeof(double), 4);
+
+  // Mark the rows of the members dropped, if the population has shrunk:
+  const int size = population.size();
+  for (int j = 0; j < dimension && size < popsize; j++) {
+    std::fill(matrix.begin() + j * popsize + size, matrix.begin() + (j + 1) * popsize, NAN);
+  }
+  population.write(matrix.data(), popsize);
+
+  // Write the best member, scores (padded) and the population:
+  write(bestMember.data(), sizeof(double), dimension);
+  write(scores.data(), sizeof(double), size);
+  write(padding.data(), sizeof(double), popsize - size);
+  write(matrix.data(), sizeof(double), matrix.size());
+  count++;
+}
+
+
+void HistoryFile::close () {
+  // Update the number of generations in the header:
+  if (std::fseek(file, 24, SEEK_SET) != 0) {
+    Rcpp::stop("Can not update the history file header.");
+  }
+  write(&count, sizeof(count), 1);
+
+  // Close the file:
+  const int status = std::fclose(file);
+  file = NULL;
+  if (status != 0) {
+    Rcpp::stop("Can not close the history file.");
+  }
+}
+
+
+void HistoryFile::write (const void* data, size_t size, size_t count) {
+  if (std::fwrite(data, size, count, file) != count) {
+    Rcpp::stop("Can not write to the history file.");
+  }
+}
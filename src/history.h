@@ -0,0 +1,218 @@
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <stdint.h>
+#include <Rcpp.h>
+#include "population.h"
+
+
+#ifndef deflex_history_h
+#define deflex_history_h
+
+/**
+ * Enumerates the policies of retaining the history of the evolution.
+ */
+enum Retention {
+  /**
+   * Retains every generation.
+   */
+  RETAIN_ALL,
+
+  /**
+   * Retains the final generation only.
+   */
+  RETAIN_FINAL,
+
+  /**
+   * Retains the initial, every k-th and the final generation.
+   */
+  RETAIN_EVERY,
+
+  /**
+   * Retains the best member and score of every generation, but the
+   * population and scores of the final generation only.
+   */
+  RETAIN_BEST,
+
+  /**
+   * Retains the last N generations.
+   */
+  RETAIN_LAST
+};
+
+
+/**
+ * Parses the history retention policy.
+ *
+ * @param name One of `"all"`, `"final"`, `"every"`, `"best"` or `"last"`.
+ * @return The retention policy.
+ */
+Retention parseRetention (const std::string& name);
+
+
+/**
+ * Keeps the history of the evolution as per the retention policy.
+ *
+ * Populations and scores are copied only when they are retained. The
+ * ring buffer of the `RETAIN_LAST` policy is allocated once and
+ * overwritten in place afterwards, unless the population shrinks in
+ * the meantime. Retained populations have as many rows as the
+ * population had at their generation.
+ */
+class History {
+public:
+  /**
+   * @param policy    The retention policy.
+   * @param every     Interval of generations for `RETAIN_EVERY`.
+   * @param size      Number of generations for `RETAIN_LAST`.
+   * @param dimension Problem dimension.
+   */
+  History (Retention policy, int every, int size, int dimension);
+
+  /**
+   * Records a generation.
+   *
+   * @param generation The generation.
+   * @param population The population.
+   * @param scores     The population scores.
+   * @param bestMember The best member.
+   * @param bestScore  The best score.
+   */
+  void record (int generation,
+               const Population& population,
+               const std::vector<double>& scores,
+               const std::vector<double>& bestMember,
+               double bestScore);
+
+  /**
+   * Records the final generation unless it is already recorded.
+   *
+   * @param generation The generation.
+   * @param population The population.
+   * @param scores     The population scores.
+   * @param bestMember The best member.
+   * @param bestScore  The best score.
+   */
+  void finish (int generation,
+               const Population& population,
+               const std::vector<double>& scores,
+               const std::vector<double>& bestMember,
+               double bestScore);
+
+  /**
+   * @return Retained populations, oldest first.
+   */
+  Rcpp::List populations () const;
+
+  /**
+   * @return Retained population scores, oldest first.
+   */
+  Rcpp::List scores () const;
+
+  /**
+   * @return Retained best members, oldest first.
+   */
+  Rcpp::List bestMembers () const;
+
+  /**
+   * @return Retained best scores, oldest first.
+   */
+  Rcpp::List bestScores () const;
+
+  /**
+   * @return Generations of the retained populations, oldest first.
+   */
+  Rcpp::IntegerVector generations () const;
+
+private:
+  void keepPopulation (int generation, const Population& population, const std::vector<double>& scores);
+  void keepBest (const std::vector<double>& bestMember, double bestScore);
+  int position (int i) const;
+
+  Retention policy;
+  int every;
+  int size;
+  int dimension;
+  int last;
+  int head;
+  std::vector<Rcpp::NumericMatrix> populationSlots;
+  std::vector<Rcpp::NumericVector> scoreSlots;
+  std::vector<Rcpp::NumericVector> bestMemberSlots;
+  std::vector<double> bestScoreSlots;
+  std::vector<int> generationSlots;
+};
+
+
+/**
+ * Streams the history of the evolution to an append-only binary file.
+ *
+ * The file starts with a 64-byte header:
+ *
+ * - magic `DEFLEXH` followed by a zero byte (8 bytes),
+ * - format version (int32),
+ * - problem dimension D (int32),
+ * - population size NP (int32),
+ * - reserved (int32),
+ * - number of generations written (int64, updated when closed),
+ * - zero padding up to 64 bytes.
+ *
+ * It is followed by one fixed-size record of `4 + D + NP + NP * D`
+ * doubles per generation: generation, best score, meanCR, meanF, best
+ * member, population scores and population in R's column-major matrix
+ * layout. Numbers are written in the native byte order. If the
+ * population shrinks, scores and rows of the members dropped are NaN.
+ */
+class HistoryFile {
+public:
+  /**
+   * Creates the file and writes the header.
+   *
+   * @param path      Path to the file.
+   * @param popsize   Initial population size.
+   * @param dimension Problem dimension.
+   */
+  HistoryFile (const std::string& path, int popsize, int dimension);
+
+  /**
+   * Closes the file if not closed yet.
+   */
+  ~HistoryFile ();
+
+  /**
+   * Appends a generation.
+   *
+   * @param generation The generation.
+   * @param population The population.
+   * @param scores     The population scores.
+   * @param bestMember The best member.
+   * @param bestScore  The best score.
+   * @param meanCR     Mean crossover probability.
+   * @param meanF      Mean differential weighting factor.
+   */
+  void append (int generation,
+               const Population& population,
+               const std::vector<double>& scores,
+               const std::vector<double>& bestMember,
+               double bestScore,
+               double meanCR,
+               double meanF);
+
+  /**
+   * Updates the number of generations in the header and closes the
+   * file.
+   */
+  void close ();
+
+private:
+  void write (const void* data, size_t size, size_t count);
+
+  std::FILE* file;
+  std::vector<char> buffer;
+  std::vector<double> matrix;
+  std::vector<double> padding;
+  int popsize;
+  int dimension;
+  int64_t count;
+};
+
+#endif
@@ -0,0 +1,73 @@
+#include <numeric>
+#include <algorithm>
+#include "islands.h"
+
+Topology parseTopology (const std::string& name) {
+  if (name == "ring") {
+    return TOPOLOGY_RING;
+  }
+  else if (name == "random") {
+    return TOPOLOGY_RANDOM;
+  }
+  Rcpp::stop("Unknown migration topology: " + name);
+}
+
+
+void migrate (std::vector<State>& islands, Topology topology, int migrants, Random& rng) {
+  // Get the number of islands and the problem dimension:
+  const int count = islands.size();
+  const int dimension = islands[0].population.width();
+
+  // Nowhere to migrate to:
+  if (count < 2 || migrants < 1) {
+    return;
+  }
+
+  // Take the best members of each island as migrants:
+  std::vector<double> members(static_cast<size_t>(count) * migrants * dimension);
+  std::vector<double> scores(static_cast<size_t>(count) * migrants);
+  std::vector<int> order;
+  for (int k = 0; k < count; k++) {
+    const State& island = islands[k];
+    order.resize(island.population.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::partial_sort(order.begin(), order.begin() + migrants, order.end(),
+                      [&island] (int a, int b) { return island.scores[a] < island.scores[b]; });
+    for (int m = 0; m < migrants; m++) {
+      double* member = &members[(static_cast<size_t>(k) * migrants + m) * dimension];
+      for (int j = 0; j < dimension; j++) {
+        member[j] = island.population(order[m], j);
+      }
+      scores[k * migrants + m] = island.scores[order[m]];
+    }
+  }
+
+  // Send migrants to their destinations:
+  for (int k = 0; k < count; k++) {
+    // Pick the destination:
+    int destination = (k + 1) % count;
+    if (topology == TOPOLOGY_RANDOM) {
+      destination = rng.index(count - 1);
+      destination += destination >= k ? 1 : 0;
+    }
+    State& island = islands[destination];
+
+    // Replace the worst members of the destination if migrants are better:
+    order.resize(island.population.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::partial_sort(order.begin(), order.begin() + migrants, order.end(),
+                      [&island] (int a, int b) { return island.scores[a] > island.scores[b]; });
+    for (int m = 0; m < migrants; m++) {
+      const double* member = &members[(static_cast<size_t>(k) * migrants + m) * dimension];
+      const double score = scores[k * migrants + m];
+      if (score < island.scores[order[m]]) {
+        island.population.assign(order[m], member);
+        island.scores[order[m]] = score;
+        if (score < island.bestScore) {
+          island.bestScore = score;
+          std::copy(member, member + dimension, island.bestMember.begin());
+        }
+      }
+    }
+  }
+}
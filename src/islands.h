@@ -0,0 +1,49 @@
+#include <string>
+#include <vector>
+#include "engine.h"
+
+#ifndef deflex_islands_h
+#define deflex_islands_h
+
+/**
+ * Provides the migration topologies of the island model.
+ */
+enum Topology {
+  /**
+   * Each island sends its migrants to the next island, and the last
+   * one to the first one.
+   */
+  TOPOLOGY_RING,
+
+  /**
+   * Each island sends its migrants to another island picked randomly
+   * at each migration.
+   */
+  TOPOLOGY_RANDOM
+};
+
+
+/**
+ * Parses the migration topology.
+ *
+ * @param name One of `"ring"` or `"random"`.
+ * @return The migration topology.
+ */
+Topology parseTopology (const std::string& name);
+
+
+/**
+ * Migrates the best members of each island to another one as per the
+ * topology.
+ *
+ * Migrants are taken from all islands before any arrives, and replace
+ * the worst members of the destination island if they are better.
+ *
+ * @param islands  States of the islands.
+ * @param topology The migration topology.
+ * @param migrants Number of migrants per island.
+ * @param rng      Random number generator to pick destinations with.
+ */
+void migrate (std::vector<State>& islands, Topology topology, int migrants, Random& rng);
+
+#endif
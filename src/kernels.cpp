@@ -0,0 +1,265 @@
+#include <cmath>
+#include "kernels.h"
+
+// Keep multiplications and additions apart (no fused multiply-add) so
+// that all kernel versions give the same results:
+#if defined(__clang__)
+#pragma STDC FP_CONTRACT OFF
+#elif defined(__GNUC__)
+#pragma GCC optimize ("fp-contract=off")
+#endif
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define DEFLEX_X86_KERNELS 1
+#include <immintrin.h>
+#endif
+
+
+////////////
+// SCALAR //
+////////////
+
+static int mutateScalar (double* trial, const double* best, const double* donor1, const double* donor2,
+                         const double* jitter, const double* lower, const double* upper, int count) {
+  int repairs = 0;
+  for (int i = 0; i < count; i++) {
+    trial[i] = best[i] + jitter[i] * (donor1[i] - donor2[i]);
+    if (std::isnan(trial[i])) {
+      trial[i] = (upper[i] + lower[i]) / 2.0;
+      repairs++;
+    }
+  }
+  return repairs;
+}
+
+
+static void crossoverScalar (double* trial, const double* mutant, const double* uniforms, double cr, int forced, int count) {
+  for (int i = 0; i < count; i++) {
+    if (uniforms[i] < cr || i == forced) {
+      trial[i] = mutant[i];
+    }
+  }
+}
+
+
+static void roundScalar (double* values, double step, int count) {
+  for (int i = 0; i < count; i++) {
+    const double down = std::floor(values[i] / step) * step;
+    const double up = std::ceil(values[i] / step) * step;
+    values[i] = std::abs(values[i] - down) < std::abs(values[i] - up) ? down : up;
+  }
+}
+
+
+static void clampScalar (double* values, const double* lower, const double* upper, int count) {
+  for (int i = 0; i < count; i++) {
+    if (values[i] < lower[i]) {
+      values[i] = lower[i];
+    }
+    if (values[i] > upper[i]) {
+      values[i] = upper[i];
+    }
+  }
+}
+
+
+static int violationScalar (const double* values, const double* lower, const double* upper, int from, int count) {
+  for (int i = from; i < count; i++) {
+    if (values[i] < lower[i] || values[i] > upper[i]) {
+      return i;
+    }
+  }
+  return count;
+}
+
+
+#ifdef DEFLEX_X86_KERNELS
+
+//////////
+// AVX2 //
+//////////
+
+__attribute__((target("avx2")))
+static int mutateAvx2 (double* trial, const double* best, const double* donor1, const double* donor2,
+                       const double* jitter, const double* lower, const double* upper, int count) {
+  const __m256d two = _mm256_set1_pd(2.0);
+  int repairs = 0;
+  int i = 0;
+  for (; i + 4 <= count; i += 4) {
+    const __m256d difference = _mm256_sub_pd(_mm256_loadu_pd(donor1 + i), _mm256_loadu_pd(donor2 + i));
+    const __m256d value = _mm256_add_pd(_mm256_loadu_pd(best + i), _mm256_mul_pd(_mm256_loadu_pd(jitter + i), difference));
+    const __m256d middle = _mm256_div_pd(_mm256_add_pd(_mm256_loadu_pd(upper + i), _mm256_loadu_pd(lower + i)), two);
+    const __m256d invalid = _mm256_cmp_pd(value, value, _CMP_UNORD_Q);
+    _mm256_storeu_pd(trial + i, _mm256_blendv_pd(value, middle, invalid));
+    repairs += __builtin_popcount(_mm256_movemask_pd(invalid));
+  }
+  return repairs + mutateScalar(trial + i, best + i, donor1 + i, donor2 + i, jitter + i, lower + i, upper + i, count - i);
+}
+
+
+__attribute__((target("avx2")))
+static void crossoverAvx2 (double* trial, const double* mutant, const double* uniforms, double cr, int forced, int count) {
+  const __m256d threshold = _mm256_set1_pd(cr);
+  int i = 0;
+  for (; i + 4 <= count; i += 4) {
+    const __m256d mask = _mm256_cmp_pd(_mm256_loadu_pd(uniforms + i), threshold, _CMP_LT_OQ);
+    _mm256_storeu_pd(trial + i, _mm256_blendv_pd(_mm256_loadu_pd(trial + i), _mm256_loadu_pd(mutant + i), mask));
+  }
+  crossoverScalar(trial + i, mutant + i, uniforms + i, cr, forced - i, count - i);
+  if (forced >= 0 && forced < i) {
+    trial[forced] = mutant[forced];
+  }
+}
+
+
+__attribute__((target("avx2")))
+static void roundAvx2 (double* values, double step, int count) {
+  const __m256d divisor = _mm256_set1_pd(step);
+  const __m256d sign = _mm256_set1_pd(-0.0);
+  int i = 0;
+  for (; i + 4 <= count; i += 4) {
+    const __m256d value = _mm256_loadu_pd(values + i);
+    const __m256d down = _mm256_mul_pd(_mm256_floor_pd(_mm256_div_pd(value, divisor)), divisor);
+    const __m256d up = _mm256_mul_pd(_mm256_ceil_pd(_mm256_div_pd(value, divisor)), divisor);
+    const __m256d toDown = _mm256_andnot_pd(sign, _mm256_sub_pd(value, down));
+    const __m256d toUp = _mm256_andnot_pd(sign, _mm256_sub_pd(value, up));
+    _mm256_storeu_pd(values + i, _mm256_blendv_pd(up, down, _mm256_cmp_pd(toDown, toUp, _CMP_LT_OQ)));
+  }
+  roundScalar(values + i, step, count - i);
+}
+
+
+__attribute__((target("avx2")))
+static void clampAvx2 (double* values, const double* lower, const double* upper, int count) {
+  int i = 0;
+  for (; i + 4 <= count; i += 4) {
+    const __m256d low = _mm256_loadu_pd(lower + i);
+    const __m256d high = _mm256_loadu_pd(upper + i);
+    __m256d value = _mm256_loadu_pd(values + i);
+    value = _mm256_blendv_pd(value, low, _mm256_cmp_pd(value, low, _CMP_LT_OQ));
+    value = _mm256_blendv_pd(value, high, _mm256_cmp_pd(value, high, _CMP_GT_OQ));
+    _mm256_storeu_pd(values + i, value);
+  }
+  clampScalar(values + i, lower + i, upper + i, count - i);
+}
+
+
+__attribute__((target("avx2")))
+static int violationAvx2 (const double* values, const double* lower, const double* upper, int from, int count) {
+  int i = from;
+  for (; i + 4 <= count; i += 4) {
+    const __m256d value = _mm256_loadu_pd(values + i);
+    const __m256d below = _mm256_cmp_pd(value, _mm256_loadu_pd(lower + i), _CMP_LT_OQ);
+    const __m256d above = _mm256_cmp_pd(value, _mm256_loadu_pd(upper + i), _CMP_GT_OQ);
+    const int mask = _mm256_movemask_pd(_mm256_or_pd(below, above));
+    if (mask != 0) {
+      return i + __builtin_ctz(mask);
+    }
+  }
+  return violationScalar(values, lower, upper, i, count);
+}
+
+
+/////////////
+// AVX-512 //
+/////////////
+
+__attribute__((target("avx512f")))
+static int mutateAvx512 (double* trial, const double* best, const double* donor1, const double* donor2,
+                         const double* jitter, const double* lower, const double* upper, int count) {
+  const __m512d two = _mm512_set1_pd(2.0);
+  int repairs = 0;
+  int i = 0;
+  for (; i + 8 <= count; i += 8) {
+    const __m512d difference = _mm512_sub_pd(_mm512_loadu_pd(donor1 + i), _mm512_loadu_pd(donor2 + i));
+    const __m512d value = _mm512_add_pd(_mm512_loadu_pd(best + i), _mm512_mul_pd(_mm512_loadu_pd(jitter + i), difference));
+    const __m512d middle = _mm512_div_pd(_mm512_add_pd(_mm512_loadu_pd(upper + i), _mm512_loadu_pd(lower + i)), two);
+    const __mmask8 invalid = _mm512_cmp_pd_mask(value, value, _CMP_UNORD_Q);
+    _mm512_storeu_pd(trial + i, _mm512_mask_blend_pd(invalid, value, middle));
+    repairs += __builtin_popcount(invalid);
+  }
+  return repairs + mutateScalar(trial + i, best + i, donor1 + i, donor2 + i, jitter + i, lower + i, upper + i, count - i);
+}
+
+
+__attribute__((target("avx512f")))
+static void crossoverAvx512 (double* trial, const double* mutant, const double* uniforms, double cr, int forced, int count) {
+  const __m512d threshold = _mm512_set1_pd(cr);
+  int i = 0;
+  for (; i + 8 <= count; i += 8) {
+    const __mmask8 mask = _mm512_cmp_pd_mask(_mm512_loadu_pd(uniforms + i), threshold, _CMP_LT_OQ);
+    _mm512_storeu_pd(trial + i, _mm512_mask_blend_pd(mask, _mm512_loadu_pd(trial + i), _mm512_loadu_pd(mutant + i)));
+  }
+  crossoverScalar(trial + i, mutant + i, uniforms + i, cr, forced - i, count - i);
+  if (forced >= 0 && forced < i) {
+    trial[forced] = mutant[forced];
+  }
+}
+
+
+__attribute__((target("avx512f")))
+static void roundAvx512 (double* values, double step, int count) {
+  const __m512d divisor = _mm512_set1_pd(step);
+  int i = 0;
+  for (; i + 8 <= count; i += 8) {
+    const __m512d value = _mm512_loadu_pd(values + i);
+    const __m512d down = _mm512_mul_pd(_mm512_roundscale_pd(_mm512_div_pd(value, divisor), _MM_FROUND_TO_NEG_INF | _MM_FROUND_NO_EXC), divisor);
+    const __m512d up = _mm512_mul_pd(_mm512_roundscale_pd(_mm512_div_pd(value, divisor), _MM_FROUND_TO_POS_INF | _MM_FROUND_NO_EXC), divisor);
+    const __m512d toDown = _mm512_abs_pd(_mm512_sub_pd(value, down));
+    const __m512d toUp = _mm512_abs_pd(_mm512_sub_pd(value, up));
+    _mm512_storeu_pd(values + i, _mm512_mask_blend_pd(_mm512_cmp_pd_mask(toDown, toUp, _CMP_LT_OQ), up, down));
+  }
+  roundScalar(values + i, step, count - i);
+}
+
+
+__attribute__((target("avx512f")))
+static void clampAvx512 (double* values, const double* lower, const double* upper, int count) {
+  int i = 0;
+  for (; i + 8 <= count; i += 8) {
+    const __m512d low = _mm512_loadu_pd(lower + i);
+    const __m512d high = _mm512_loadu_pd(upper + i);
+    __m512d value = _mm512_loadu_pd(values + i);
+    value = _mm512_mask_blend_pd(_mm512_cmp_pd_mask(value, low, _CMP_LT_OQ), value, low);
+    value = _mm512_mask_blend_pd(_mm512_cmp_pd_mask(value, high, _CMP_GT_OQ), value, high);
+    _mm512_storeu_pd(values + i, value);
+  }
+  clampScalar(values + i, lower + i, upper + i, count - i);
+}
+
+
+__attribute__((target("avx512f")))
+static int violationAvx512 (const double* values, const double* lower, const double* upper, int from, int count) {
+  int i = from;
+  for (; i + 8 <= count; i += 8) {
+    const __m512d value = _mm512_loadu_pd(values + i);
+    const __mmask8 below = _mm512_cmp_pd_mask(value, _mm512_loadu_pd(lower + i), _CMP_LT_OQ);
+    const __mmask8 above = _mm512_cmp_pd_mask(value, _mm512_loadu_pd(upper + i), _CMP_GT_OQ);
+    const int mask = below | above;
+    if (mask != 0) {
+      return i + __builtin_ctz(mask);
+    }
+  }
+  return violationScalar(values, lower, upper, i, count);
+}
+
+#endif
+
+
+const Kernels& selectKernels (bool simd) {
+  static const Kernels scalar = { mutateScalar, crossoverScalar, roundScalar, clampScalar, violationScalar, "scalar" };
+#ifdef DEFLEX_X86_KERNELS
+  static const Kernels avx2 = { mutateAvx2, crossoverAvx2, roundAvx2, clampAvx2, violationAvx2, "avx2" };
+  static const Kernels avx512 = { mutateAvx512, crossoverAvx512, roundAvx512, clampAvx512, violationAvx512, "avx512" };
+  if (simd) {
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) {
+      return avx512;
+    }
+    if (__builtin_cpu_supports("avx2")) {
+      return avx2;
+    }
+  }
+#endif
+  return scalar;
+}
@@ -0,0 +1,94 @@
+#ifndef deflex_kernels_h
+#define deflex_kernels_h
+
+/**
+ * Provides the kernels which work on whole rows of trials.
+ *
+ * There is a scalar version of each kernel, and AVX2 and AVX-512
+ * versions on x86 CPUs supporting them. All versions perform the same
+ * floating point operations in the same order, hence give the same
+ * results. Kernels which may need random numbers (such as bouncing
+ * back) only detect the elements to work on, and leave drawing to the
+ * caller so that random numbers are drawn in the same order.
+ */
+struct Kernels {
+  /**
+   * Mutates a contiguous run of trial elements:
+   * `trial[i] = best[i] + jitter[i] * (donor1[i] - donor2[i])`. NaN
+   * results are reset to the middle of the bounds.
+   *
+   * @param trial  The trial (output).
+   * @param best   The best member.
+   * @param donor1 The first donor.
+   * @param donor2 The second donor.
+   * @param jitter Differential weighting factor per element.
+   * @param lower  Lower-bounds.
+   * @param upper  Upper-bounds.
+   * @param count  Number of elements.
+   * @return Number of NaN results reset.
+   */
+  int (*mutate) (double* trial, const double* best, const double* donor1, const double* donor2,
+                 const double* jitter, const double* lower, const double* upper, int count);
+
+  /**
+   * Applies binomial crossover: takes the mutant element if the uniform
+   * random number of the element is less than the crossover probability
+   * or if it is the element which is always taken.
+   *
+   * @param trial    The trial (output).
+   * @param mutant   The mutant.
+   * @param uniforms Uniform random numbers, one per element.
+   * @param cr       Crossover probability.
+   * @param forced   The element which is always taken.
+   * @param count    Number of elements.
+   */
+  void (*crossover) (double* trial, const double* mutant, const double* uniforms, double cr, int forced, int count);
+
+  /**
+   * Rounds elements to the closest multiple of the step (see
+   * `roundToClosest`).
+   *
+   * @param values The values (output).
+   * @param step   Precision step (non-zero).
+   * @param count  Number of elements.
+   */
+  void (*round) (double* values, double step, int count);
+
+  /**
+   * Clamps elements to the lower and then upper bounds.
+   *
+   * @param values The values (output).
+   * @param lower  Lower-bounds.
+   * @param upper  Upper-bounds.
+   * @param count  Number of elements.
+   */
+  void (*clamp) (double* values, const double* lower, const double* upper, int count);
+
+  /**
+   * Finds the next element violating bounds.
+   *
+   * @param values The values.
+   * @param lower  Lower-bounds.
+   * @param upper  Upper-bounds.
+   * @param from   The element to start with.
+   * @param count  Number of elements.
+   * @return The index of the next violating element, `count` if none.
+   */
+  int (*violation) (const double* values, const double* lower, const double* upper, int from, int count);
+
+  /**
+   * Name of the instruction set: `"scalar"`, `"avx2"` or `"avx512"`.
+   */
+  const char* name;
+};
+
+
+/**
+ * Selects the kernels for the CPU.
+ *
+ * @param simd Whether to use SIMD kernels if the CPU supports them.
+ * @return The kernels.
+ */
+const Kernels& selectKernels (bool simd);
+
+#endif
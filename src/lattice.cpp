@@ -0,0 +1,35 @@
+#include <cmath>
+#include <string>
+#include <Rcpp.h>
+#include "lattice.h"
+
+Lattice::Lattice (int dimension, const double* lower, const double* upper, double step)
+  : dimension(dimension), step(step), lower(lower, lower + dimension), upper(upper, upper + dimension), first(dimension), span(dimension) {
+  // Check the precision:
+  if (!(step > 0)) {
+    Rcpp::stop("Lattice mode requires a positive precision.");
+  }
+
+  // Find the first and last lattice points within the bounds of each parameter, allowing for representation errors:
+  for (int j = 0; j < dimension; j++) {
+    const double from = std::ceil(lower[j] / step - 1e-9);
+    const double to = std::floor(upper[j] / step + 1e-9);
+    if (to < from) {
+      Rcpp::stop("No lattice point within the bounds of parameter " + std::to_string(j + 1) + ".");
+    }
+    if (to - from > INT32_MAX || std::fabs(from) > 9007199254740992.0) {
+      Rcpp::stop("Too many lattice points within the bounds of parameter " + std::to_string(j + 1) + ".");
+    }
+    first[j] = static_cast<int64_t>(from);
+    span[j] = static_cast<int32_t>(to - from);
+  }
+}
+
+
+void Lattice::snap (double* matrix, int rows) const {
+  for (int j = 0; j < dimension; j++) {
+    for (int i = 0; i < rows; i++) {
+      matrix[i + j * rows] = snap(matrix[i + j * rows], j);
+    }
+  }
+}
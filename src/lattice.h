@@ -0,0 +1,76 @@
+#include <cmath>
+#include <vector>
+#include <stdint.h>
+
+#ifndef deflex_lattice_h
+#define deflex_lattice_h
+
+/**
+ * Provides the lattice of a precision-constrained problem, ie. the
+ * multiples of the precision within the bounds of each parameter.
+ *
+ * Values are snapped to integer offsets from the first lattice point
+ * within the lower bound, clamped to the last one within the upper
+ * bound in integer arithmetic, and decoded as `(first + offset) *
+ * step`. As the decoded value may round past a bound by an ulp, it is
+ * clamped to the bounds, too. Snapped values are hence always within
+ * bounds, and the same lattice point always decodes to the same double,
+ * so that scores of duplicates are found in the cache exactly.
+ *
+ * This is a rounding mode of trials only: populations are stored and
+ * mutated as doubles all the same.
+ */
+class Lattice {
+public:
+  /**
+   * @param dimension Problem dimension.
+   * @param lower     Lower-bounds.
+   * @param upper     Upper-bounds.
+   * @param step      Precision, ie. the lattice spacing.
+   */
+  Lattice (int dimension, const double* lower, const double* upper, double step);
+
+  /**
+   * Snaps a value of a parameter to the closest lattice point within
+   * bounds.
+   *
+   * @param value     The value.
+   * @param parameter The parameter index.
+   * @return The lattice point.
+   */
+  inline double snap (double value, int parameter) const {
+    int64_t offset = static_cast<int64_t>(std::llrint(value / step)) - first[parameter];
+    offset = offset < 0 ? 0 : (offset > span[parameter] ? span[parameter] : offset);
+    const double point = static_cast<double>(first[parameter] + offset) * step;
+    return point < lower[parameter] ? lower[parameter] : (point > upper[parameter] ? upper[parameter] : point);
+  }
+
+  /**
+   * Snaps a vector to the lattice.
+   *
+   * @param values The vector of `dimension` elements.
+   */
+  inline void snap (double* values) const {
+    for (int j = 0; j < dimension; j++) {
+      values[j] = snap(values[j], j);
+    }
+  }
+
+  /**
+   * Snaps the rows of a column-major matrix to the lattice.
+   *
+   * @param matrix The matrix of `rows` rows and `dimension` columns.
+   * @param rows   Number of rows.
+   */
+  void snap (double* matrix, int rows) const;
+
+private:
+  int dimension;
+  double step;
+  std::vector<double> lower;
+  std::vector<double> upper;
+  std::vector<int64_t> first;
+  std::vector<int32_t> span;
+};
+
+#endif
@@ -0,0 +1,111 @@
+#include "pipeline.h"
+
+Pipeline::Pipeline (int workers, int capacity, int dimension, const std::function<double(const double*)>& evaluate)
+  : evaluate(evaluate), capacity(capacity), dimension(dimension), trials(static_cast<size_t>(capacity) * dimension),
+    tags(capacity), scores(capacity), errors(capacity), stopping(false) {
+  for (int i = capacity - 1; i >= 0; i--) {
+    free.push_back(i);
+  }
+  for (int i = 0; i < workers; i++) {
+    this->workers.push_back(std::thread(&Pipeline::work, this));
+  }
+}
+
+
+Pipeline::~Pipeline () {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stopping = true;
+  }
+  wakeup.notify_all();
+  for (size_t i = 0; i < workers.size(); i++) {
+    workers[i].join();
+  }
+}
+
+
+int Pipeline::acquire () {
+  const int slot = free.back();
+  free.pop_back();
+  return slot;
+}
+
+
+void Pipeline::submit (int slot, int tag) {
+  tags[slot] = tag;
+
+  // Evaluate on the calling thread if there are no evaluators:
+  if (workers.empty()) {
+    try {
+      scores[slot] = evaluate(trial(slot));
+    }
+    catch (...) {
+      errors[slot] = std::current_exception();
+    }
+    done.push_back(slot);
+    return;
+  }
+
+  // Hand over to evaluators:
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    pending.push_back(slot);
+  }
+  wakeup.notify_one();
+}
+
+
+int Pipeline::receive () {
+  // Wait for the next evaluated slot:
+  int slot;
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    finished.wait(lock, [this] { return !done.empty(); });
+    slot = done.front();
+    done.pop_front();
+  }
+
+  // Re-throw the exception of the evaluation, if any:
+  if (errors[slot]) {
+    std::exception_ptr error = errors[slot];
+    errors[slot] = std::exception_ptr();
+    release(slot);
+    std::rethrow_exception(error);
+  }
+
+  // Done, return:
+  return slot;
+}
+
+
+void Pipeline::release (int slot) {
+  free.push_back(slot);
+}
+
+
+void Pipeline::work () {
+  std::unique_lock<std::mutex> lock(mutex);
+  while (true) {
+    // Wait for a submitted slot:
+    wakeup.wait(lock, [this] { return stopping || !pending.empty(); });
+    if (stopping) {
+      return;
+    }
+    const int slot = pending.front();
+    pending.pop_front();
+
+    // Evaluate without holding the lock:
+    lock.unlock();
+    try {
+      scores[slot] = evaluate(trial(slot));
+    }
+    catch (...) {
+      errors[slot] = std::current_exception();
+    }
+    lock.lock();
+
+    // Hand over to the calling thread:
+    done.push_back(slot);
+    finished.notify_one();
+  }
+}
@@ -0,0 +1,143 @@
+#include <deque>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <exception>
+#include <functional>
+#include <condition_variable>
+
+
+#ifndef deflex_pipeline_h
+#define deflex_pipeline_h
+
+/**
+ * Provides a bounded pipeline of trial evaluations served by a pool of
+ * evaluator threads.
+ *
+ * The pipeline has a fixed number of slots, each holding a trial, the
+ * tag of its candidate and its score. The calling thread acquires a
+ * free slot, writes the trial into it and submits it. Evaluators take
+ * submitted slots in order, and the calling thread receives evaluated
+ * ones in the order they finish, and releases them. Without any
+ * evaluator threads, trials are evaluated on the calling thread as
+ * they are submitted.
+ *
+ * The evaluation function must not call into R if there are evaluator
+ * threads. Exceptions it throws are re-thrown to the caller of
+ * `receive` for the respective slot.
+ */
+class Pipeline {
+public:
+  /**
+   * Starts the evaluator threads.
+   *
+   * @param workers   Number of evaluator threads (`0` to evaluate on the calling thread).
+   * @param capacity  Number of slots, ie. maximum number of trials in the pipeline.
+   * @param dimension Number of parameters of a trial.
+   * @param evaluate  The evaluation function.
+   */
+  Pipeline (int workers, int capacity, int dimension, const std::function<double(const double*)>& evaluate);
+
+  /**
+   * Stops and joins the evaluator threads, abandoning trials not
+   * evaluated yet.
+   */
+  ~Pipeline ();
+
+  /**
+   * @return Number of free slots.
+   */
+  int available () const {
+    return free.size();
+  }
+
+  /**
+   * @return Number of slots submitted but not released yet.
+   */
+  int inflight () const {
+    return capacity - free.size();
+  }
+
+  /**
+   * Acquires a free slot. There must be one available.
+   *
+   * @return The slot.
+   */
+  int acquire ();
+
+  /**
+   * @param slot The slot.
+   * @return The trial of the slot.
+   */
+  double* trial (int slot) {
+    return &trials[static_cast<size_t>(slot) * dimension];
+  }
+
+  /**
+   * Submits the slot for evaluation.
+   *
+   * @param slot The slot.
+   * @param tag  The tag of the slot, ie. the candidate.
+   */
+  void submit (int slot, int tag);
+
+  /**
+   * Waits for the next evaluated slot. There must be one in flight.
+   *
+   * @return The slot.
+   */
+  int receive ();
+
+  /**
+   * @param slot The slot.
+   * @return The tag of the slot.
+   */
+  int tag (int slot) const {
+    return tags[slot];
+  }
+
+  /**
+   * @param slot The slot.
+   * @return The score of the slot.
+   */
+  double score (int slot) const {
+    return scores[slot];
+  }
+
+  /**
+   * Releases a received slot.
+   *
+   * @param slot The slot.
+   */
+  void release (int slot);
+
+private:
+  void work ();
+
+  std::function<double(const double*)> evaluate;
+  int capacity;
+  int dimension;
+  std::vector<double> trials;
+  std::vector<int> tags;
+  std::vector<double> scores;
+  std::vector<std::exception_ptr> errors;
+
+  /**
+   * Free slots, used by the calling thread only.
+   */
+  std::vector<int> free;
+
+  /**
+   * Slots submitted and evaluated, guarded by the mutex.
+   */
+  std::deque<int> pending;
+  std::deque<int> done;
+
+  std::vector<std::thread> workers;
+  std::mutex mutex;
+  std::condition_variable wakeup;
+  std::condition_variable finished;
+  bool stopping;
+};
+
+#endif
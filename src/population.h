@@ -0,0 +1,262 @@
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <stdexcept>
+#include <stdint.h>
+#include <algorithm>
+
+#ifndef deflex_population_h
+#define deflex_population_h
+
+/**
+ * Enumerates population storage layouts.
+ */
+enum Layout {
+  /**
+   * Row-major: each member is stored in a contiguous row.
+   */
+  LAYOUT_ROWS,
+
+  /**
+   * Column-major (structure of arrays): each parameter is stored in a
+   * contiguous column, same as R matrices.
+   */
+  LAYOUT_COLUMNS
+};
+
+
+/**
+ * Parses the population storage layout.
+ *
+ * @param name One of `"rows"` or `"columns"`.
+ * @return The layout.
+ */
+inline Layout parseLayout (const std::string& name) {
+  if (name == "rows") {
+    return LAYOUT_ROWS;
+  }
+  else if (name == "columns") {
+    return LAYOUT_COLUMNS;
+  }
+  throw std::invalid_argument("Unknown population layout: " + name);
+}
+
+
+/**
+ * Provides a population store as a matrix of members (rows) by
+ * parameters (columns).
+ *
+ * Rows (or columns) are padded to multiples of 64 bytes and start at
+ * 64-byte aligned addresses. Populations are converted from and to R
+ * matrices only at the API boundary.
+ */
+class Population {
+public:
+  /**
+   * @param popsize   Population size.
+   * @param dimension Problem dimension.
+   * @param layout    Storage layout.
+   */
+  Population (int popsize, int dimension, Layout layout)
+    : popsize(popsize), capacity(popsize), dimension(dimension), layout(layout) {
+    // Pad rows (or columns) to multiples of 8 doubles:
+    const size_t rows = layout == LAYOUT_ROWS ? popsize : dimension;
+    const size_t length = pad(layout == LAYOUT_ROWS ? dimension : popsize);
+    memberStride = layout == LAYOUT_ROWS ? length : 1;
+    parameterStride = layout == LAYOUT_ROWS ? 1 : length;
+
+    // Allocate with room for the alignment:
+    storage.resize(rows * length + ALIGNMENT);
+    data = align(storage.data());
+  }
+
+  Population (const Population& other)
+    : Population(other.capacity, other.dimension, other.layout) {
+    std::copy(other.data, other.data + (other.storage.size() - ALIGNMENT), data);
+    popsize = other.popsize;
+  }
+
+  Population& operator= (Population other) {
+    swap(other);
+    return *this;
+  }
+
+  /**
+   * Swaps the contents with another population without copying.
+   *
+   * @param other The other population.
+   */
+  void swap (Population& other) {
+    std::swap(popsize, other.popsize);
+    std::swap(capacity, other.capacity);
+    std::swap(dimension, other.dimension);
+    std::swap(layout, other.layout);
+    std::swap(memberStride, other.memberStride);
+    std::swap(parameterStride, other.parameterStride);
+    storage.swap(other.storage);
+    std::swap(data, other.data);
+  }
+
+  /**
+   * @return Population size.
+   */
+  inline int size () const {
+    return popsize;
+  }
+
+  /**
+   * Shrinks the population in place by dropping the members from the
+   * given index on. The storage and its strides stay the same.
+   *
+   * @param size New population size, at most the current one.
+   */
+  inline void resize (int size) {
+    popsize = std::min(size, popsize);
+  }
+
+  /**
+   * @return Problem dimension.
+   */
+  inline int width () const {
+    return dimension;
+  }
+
+  /**
+   * @return Storage layout.
+   */
+  inline Layout order () const {
+    return layout;
+  }
+
+  /**
+   * @param member    Member index.
+   * @param parameter Parameter index.
+   * @return The parameter of the member.
+   */
+  inline double& operator() (int member, int parameter) {
+    return data[member * memberStride + parameter * parameterStride];
+  }
+
+  /**
+   * @param member    Member index.
+   * @param parameter Parameter index.
+   * @return The parameter of the member.
+   */
+  inline double operator() (int member, int parameter) const {
+    return data[member * memberStride + parameter * parameterStride];
+  }
+
+  /**
+   * Provides the member as a contiguous vector.
+   *
+   * @param member  Member index.
+   * @param scratch Scratch space of `dimension` elements used unless rows are contiguous.
+   * @return Pointer to the member.
+   */
+  inline const double* row (int member, double* scratch) const {
+    if (layout == LAYOUT_ROWS) {
+      return data + member * memberStride;
+    }
+    for (int i = 0; i < dimension; i++) {
+      scratch[i] = (*this)(member, i);
+    }
+    return scratch;
+  }
+
+  /**
+   * Provides the member as a contiguous vector.
+   *
+   * Only available for the row-major layout.
+   *
+   * @param member Member index.
+   * @return Pointer to the member.
+   */
+  inline double* row (int member) {
+    return data + member * memberStride;
+  }
+
+  /**
+   * Sets the member.
+   *
+   * @param member Member index.
+   * @param values Parameters of the member.
+   */
+  inline void assign (int member, const double* values) {
+    for (int i = 0; i < dimension; i++) {
+      (*this)(member, i) = values[i];
+    }
+  }
+
+  /**
+   * Sets the member from a member of another population.
+   *
+   * @param member Member index.
+   * @param other  The other population.
+   * @param source Member index in the other population.
+   */
+  inline void assign (int member, const Population& other, int source) {
+    for (int i = 0; i < dimension; i++) {
+      (*this)(member, i) = other(source, i);
+    }
+  }
+
+  /**
+   * Reads the population from a column-major matrix.
+   *
+   * @param matrix The matrix of `popsize` rows and `dimension` columns.
+   */
+  void read (const double* matrix) {
+    for (int j = 0; j < dimension; j++) {
+      for (int i = 0; i < popsize; i++) {
+        (*this)(i, j) = matrix[i + j * popsize];
+      }
+    }
+  }
+
+  /**
+   * Writes the population to a column-major matrix.
+   *
+   * @param matrix The matrix of `popsize` rows and `dimension` columns.
+   */
+  void write (double* matrix) const {
+    write(matrix, popsize);
+  }
+
+  /**
+   * Writes the population to the top rows of a larger column-major
+   * matrix, leaving the rest of the rows as they are.
+   *
+   * @param matrix The matrix of at least `popsize` rows and `dimension` columns.
+   * @param rows   Number of rows of the matrix.
+   */
+  void write (double* matrix, int rows) const {
+    for (int j = 0; j < dimension; j++) {
+      for (int i = 0; i < popsize; i++) {
+        matrix[i + j * rows] = (*this)(i, j);
+      }
+    }
+  }
+
+private:
+  static const size_t ALIGNMENT = 64 / sizeof(double);
+
+  static inline size_t pad (size_t length) {
+    return (length + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+  }
+
+  static inline double* align (double* pointer) {
+    const uintptr_t address = reinterpret_cast<uintptr_t>(pointer);
+    return reinterpret_cast<double*>((address + 63) & ~static_cast<uintptr_t>(63));
+  }
+
+  int popsize;
+  int capacity;
+  int dimension;
+  Layout layout;
+  size_t memberStride;
+  size_t parameterStride;
+  std::vector<double> storage;
+  double* data;
+};
+
+#endif
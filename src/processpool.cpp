@@ -0,0 +1,285 @@
+#include <cmath>
+#include <cerrno>
+#include <stdint.h>
+#include <algorithm>
+#ifndef _WIN32
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <sys/socket.h>
+#endif
+#include "processpool.h"
+#include "evaluate.h"
+
+#ifndef _WIN32
+
+/**
+ * Enumerates the reply statuses of worker processes.
+ */
+enum ReplyStatus {
+  REPLY_OK = 0,
+  REPLY_ERROR = 1,
+  REPLY_NAN = 2,
+  REPLY_LENGTH = 3
+};
+
+
+/**
+ * Sends all bytes over the socket without raising `SIGPIPE`.
+ *
+ * @return True if all bytes are sent, false if the peer is gone.
+ */
+static bool transmit (int socket, const void* data, size_t size) {
+#ifdef MSG_NOSIGNAL
+  const int flags = MSG_NOSIGNAL;
+#else
+  const int flags = 0;
+#endif
+  const char* bytes = static_cast<const char*>(data);
+  while (size > 0) {
+    const ssize_t sent = send(socket, bytes, size, flags);
+    if (sent < 0 && errno == EINTR) {
+      continue;
+    }
+    if (sent <= 0) {
+      return false;
+    }
+    bytes += sent;
+    size -= sent;
+  }
+  return true;
+}
+
+
+/**
+ * Receives exactly the given number of bytes from the socket.
+ *
+ * @return True if all bytes are received, false if the peer is gone.
+ */
+static bool receive (int socket, void* data, size_t size) {
+  char* bytes = static_cast<char*>(data);
+  while (size > 0) {
+    const ssize_t received = recv(socket, bytes, size, 0);
+    if (received < 0 && errno == EINTR) {
+      continue;
+    }
+    if (received <= 0) {
+      return false;
+    }
+    bytes += received;
+    size -= received;
+  }
+  return true;
+}
+
+
+/**
+ * Evaluates the R objective function on a request in a worker process.
+ *
+ * R errors are caught and reported in the status instead of unwinding
+ * the worker.
+ *
+ * @return The reply status.
+ */
+static int32_t evaluateRequest (const Objective& objective, SEXP env, const std::vector<double>& trials, int count, int dimension,
+                                std::vector<double>& scores) {
+  int error = 0;
+  if (objective.batch) {
+    // Build the matrix of trials (one per row) and evaluate it in one call:
+    SEXP matrix = PROTECT(Rf_allocMatrix(REALSXP, count, dimension));
+    for (int i = 0; i < count; i++) {
+      for (int j = 0; j < dimension; j++) {
+        REAL(matrix)[i + j * count] = trials[i * dimension + j];
+      }
+    }
+    SEXP call = PROTECT(Rf_lang2(objective.function, matrix));
+    SEXP result = R_tryEval(call, env, &error);
+    if (error) {
+      UNPROTECT(2);
+      return REPLY_ERROR;
+    }
+    PROTECT(result = Rf_coerceVector(result, REALSXP));
+    if (Rf_length(result) != count) {
+      UNPROTECT(3);
+      return REPLY_LENGTH;
+    }
+    std::copy(REAL(result), REAL(result) + count, scores.begin());
+    UNPROTECT(3);
+  }
+  else {
+    // Evaluate trials one by one, each in a fresh vector as the objective function may keep its argument:
+    for (int i = 0; i < count; i++) {
+      SEXP trial = PROTECT(Rf_allocVector(REALSXP, dimension));
+      std::copy(trials.begin() + i * dimension, trials.begin() + (i + 1) * dimension, REAL(trial));
+      SEXP call = PROTECT(Rf_lang2(objective.function, trial));
+      SEXP result = R_tryEval(call, env, &error);
+      if (error) {
+        UNPROTECT(2);
+        return REPLY_ERROR;
+      }
+      scores[i] = Rf_asReal(result);
+      UNPROTECT(2);
+    }
+  }
+
+  // Check the scores:
+  for (int i = 0; i < count; i++) {
+    if (ISNAN(scores[i])) {
+      return REPLY_NAN;
+    }
+  }
+  return REPLY_OK;
+}
+
+
+/**
+ * Serves requests in a worker process until the session disconnects.
+ */
+static void serve (int socket, const Objective& objective, SEXP env) {
+  std::vector<double> trials;
+  std::vector<double> scores;
+  int32_t header[2];
+  while (receive(socket, header, sizeof(header))) {
+    // Receive the trials:
+    const int count = header[0];
+    const int dimension = header[1];
+    trials.resize(static_cast<size_t>(count) * dimension);
+    if (!receive(socket, trials.data(), trials.size() * sizeof(double))) {
+      return;
+    }
+
+    // Evaluate and reply with the status and the scores:
+    scores.assign(count, 0.0);
+    const int32_t status = evaluateRequest(objective, env, trials, count, dimension, scores);
+    if (!transmit(socket, &status, sizeof(status)) || !transmit(socket, scores.data(), scores.size() * sizeof(double))) {
+      return;
+    }
+  }
+}
+
+#endif
+
+
+ProcessPool::ProcessPool (int size, const Objective& objective, SEXP env) {
+#ifdef _WIN32
+  Rcpp::stop("Worker processes are not supported on Windows.");
+#else
+  if (objective.native != NULL) {
+    Rcpp::stop("Worker processes require an R objective function.");
+  }
+  for (int w = 0; w < size; w++) {
+    // Connect the session with the worker:
+    int ends[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, ends) != 0) {
+      shutdown();
+      Rcpp::stop("Cannot create the socket of a worker process.");
+    }
+#ifdef SO_NOSIGPIPE
+    const int on = 1;
+    setsockopt(ends[0], SOL_SOCKET, SO_NOSIGPIPE, &on, sizeof(on));
+    setsockopt(ends[1], SOL_SOCKET, SO_NOSIGPIPE, &on, sizeof(on));
+#endif
+
+    // Fork the worker, which serves requests until the session disconnects and exits without returning to R:
+    const pid_t pid = fork();
+    if (pid == 0) {
+      close(ends[0]);
+      for (size_t k = 0; k < sockets.size(); k++) {
+        close(sockets[k]);
+      }
+      try {
+        serve(ends[1], objective, env);
+      }
+      catch (...) {
+        _exit(1);
+      }
+      _exit(0);
+    }
+    close(ends[1]);
+    if (pid < 0) {
+      close(ends[0]);
+      shutdown();
+      Rcpp::stop("Cannot fork a worker process.");
+    }
+    pids.push_back(pid);
+    sockets.push_back(ends[0]);
+  }
+#endif
+}
+
+
+ProcessPool::~ProcessPool () {
+  shutdown();
+}
+
+
+void ProcessPool::shutdown () {
+#ifndef _WIN32
+  // Disconnect, so that workers exit, and reap them:
+  for (size_t w = 0; w < sockets.size(); w++) {
+    close(sockets[w]);
+  }
+  for (size_t w = 0; w < pids.size(); w++) {
+    while (waitpid(pids[w], NULL, 0) < 0 && errno == EINTR) {
+    }
+  }
+  sockets.clear();
+  pids.clear();
+#endif
+}
+
+
+void ProcessPool::evaluate (const Population& trials, const std::vector<int>& pending, std::vector<double>& scores) {
+#ifndef _WIN32
+  // Split pending trials into contiguous chunks, one per worker:
+  const int count = pending.size();
+  const int dimension = trials.width();
+  const int workers = std::min(size(), count);
+  bool connected = true;
+
+  // Send each chunk to its worker:
+  for (int w = 0; w < workers && connected; w++) {
+    const int from = static_cast<long>(w) * count / workers;
+    const int to = static_cast<long>(w + 1) * count / workers;
+    buffer.resize(static_cast<size_t>(to - from) * dimension);
+    for (int k = from; k < to; k++) {
+      double* slot = buffer.data() + static_cast<size_t>(k - from) * dimension;
+      const double* row = trials.row(pending[k], slot);
+      if (row != slot) {
+        std::copy(row, row + dimension, slot);
+      }
+    }
+    const int32_t header[2] = { to - from, dimension };
+    connected = transmit(sockets[w], header, sizeof(header)) && transmit(sockets[w], buffer.data(), buffer.size() * sizeof(double));
+  }
+
+  // Collect the replies in worker order, reading all of them before reporting the first failure:
+  int32_t failure = REPLY_OK;
+  for (int w = 0; w < workers && connected; w++) {
+    const int from = static_cast<long>(w) * count / workers;
+    const int to = static_cast<long>(w + 1) * count / workers;
+    int32_t status;
+    buffer.resize(to - from);
+    connected = receive(sockets[w], &status, sizeof(status)) && receive(sockets[w], buffer.data(), buffer.size() * sizeof(double));
+    for (int k = from; k < to && connected; k++) {
+      scores[pending[k]] = buffer[k - from];
+    }
+    if (connected && failure == REPLY_OK) {
+      failure = status;
+    }
+  }
+
+  // Report failures:
+  if (!connected) {
+    Rcpp::stop("Lost the connection to a worker process.");
+  }
+  switch (failure) {
+  case REPLY_ERROR:
+    Rcpp::stop("Objective function failed in a worker process.");
+  case REPLY_NAN:
+    Rcpp::stop("NaN value of objective function! \nPerhaps adjust the bounds.");
+  case REPLY_LENGTH:
+    Rcpp::stop("Batch objective function must return one score per row.");
+  }
+#endif
+}
@@ -0,0 +1,62 @@
+#include <vector>
+#include <Rcpp.h>
+#include "population.h"
+
+#ifndef deflex_processpool_h
+#define deflex_processpool_h
+
+struct Objective;
+
+/**
+ * Provides a fixed-size pool of forked R worker processes which
+ * evaluate an R objective function.
+ *
+ * Each worker is connected to the session over a Unix domain socket.
+ * Trials are sent to the workers in contiguous chunks as raw doubles
+ * (a header of the number of trials and the dimension followed by the
+ * trials row by row), and the scores come back in the same order, so
+ * that the scores do not depend on the number of workers. Workers are
+ * forked from the session, hence see its R objects as they were when
+ * the pool was started. Not available on Windows.
+ */
+class ProcessPool {
+public:
+  /**
+   * Forks the worker processes.
+   *
+   * @param size      Number of worker processes.
+   * @param objective The R objective function.
+   * @param env       Environment to evaluate the objective function within.
+   */
+  ProcessPool (int size, const Objective& objective, SEXP env);
+
+  /**
+   * Disconnects from and reaps the worker processes.
+   */
+  ~ProcessPool ();
+
+  /**
+   * Evaluates trials on the workers and waits until all are done.
+   *
+   * @param trials  Trials.
+   * @param pending Indices of trials to evaluate.
+   * @param scores  The trial scores (output).
+   */
+  void evaluate (const Population& trials, const std::vector<int>& pending, std::vector<double>& scores);
+
+  /**
+   * @return Number of worker processes.
+   */
+  int size () const {
+    return sockets.size();
+  }
+
+private:
+  void shutdown ();
+
+  std::vector<int> pids;
+  std::vector<int> sockets;
+  std::vector<double> buffer;
+};
+
+#endif
@@ -0,0 +1,54 @@
+#include <cmath>
+#include <limits>
+#include <algorithm>
+#include <Rcpp.h>
+#include "reduction.h"
+
+ReductionKind parseReduction (const std::string& name) {
+  if (name == "none") {
+    return REDUCE_NONE;
+  }
+  else if (name == "linear") {
+    return REDUCE_LINEAR;
+  }
+  else if (name == "schedule") {
+    return REDUCE_SCHEDULE;
+  }
+  Rcpp::stop("Unknown population size reduction: " + name);
+}
+
+
+Reduction::Reduction (ReductionKind kind, int initial, int minimum, int iterations, double maxEvaluations, const std::vector<int>& schedule, int smallest)
+  : kind(kind), initial(initial), minimum(minimum < 1 ? std::max(4, smallest) : minimum), iterations(iterations), maxEvaluations(maxEvaluations), schedule(schedule) {
+  // Check the settings:
+  if (kind == REDUCE_LINEAR && this->minimum < smallest) {
+    Rcpp::stop("Minimum population size must be at least " + std::to_string(smallest) + ".");
+  }
+  if (kind == REDUCE_SCHEDULE) {
+    if (schedule.empty()) {
+      Rcpp::stop("Population size schedule must not be empty.");
+    }
+    if (*std::min_element(schedule.begin(), schedule.end()) < smallest) {
+      Rcpp::stop("Population sizes must be at least " + std::to_string(smallest) + ".");
+    }
+  }
+}
+
+
+int Reduction::size (int generation, double evaluations, int current) const {
+  switch (kind) {
+  case REDUCE_LINEAR: {
+    // Get the progress over the evaluation budget, or over the iterations if the budget is not limited:
+    const double progress = maxEvaluations < std::numeric_limits<double>::infinity() ?
+      evaluations / maxEvaluations : static_cast<double>(generation) / iterations;
+
+    // Interpolate between the initial and the minimum size:
+    const int target = static_cast<int>(std::round(initial + (minimum - initial) * std::min(1.0, progress)));
+    return std::min(current, std::max(minimum, target));
+  }
+  case REDUCE_SCHEDULE:
+    return std::min(current, schedule[std::min(generation, static_cast<int>(schedule.size())) - 1]);
+  default:
+    return current;
+  }
+}
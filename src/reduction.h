@@ -0,0 +1,85 @@
+#include <string>
+#include <vector>
+
+#ifndef deflex_reduction_h
+#define deflex_reduction_h
+
+/**
+ * Enumerates the population size reduction schedules.
+ */
+enum ReductionKind {
+  /**
+   * Keeps the population size fixed.
+   */
+  REDUCE_NONE,
+
+  /**
+   * Shrinks the population size linearly from the initial size to the
+   * minimum over the evaluation budget (as in L-SHADE), or over the
+   * iterations if the budget is not limited.
+   */
+  REDUCE_LINEAR,
+
+  /**
+   * Shrinks the population size as per a user-supplied schedule.
+   */
+  REDUCE_SCHEDULE
+};
+
+
+/**
+ * Parses the population size reduction schedule.
+ *
+ * @param name One of `"none"`, `"linear"` or `"schedule"`.
+ * @return The reduction schedule.
+ */
+ReductionKind parseReduction (const std::string& name);
+
+
+/**
+ * Gives the population size after each generation as per the
+ * reduction schedule.
+ *
+ * The population size never grows: a schedule which asks for a larger
+ * size than the current one keeps the current size.
+ */
+class Reduction {
+public:
+  /**
+   * @param kind           The reduction schedule.
+   * @param initial        Initial population size.
+   * @param minimum        Minimum population size for `REDUCE_LINEAR`.
+   * @param iterations     Number of iterations.
+   * @param maxEvaluations Maximum number of evaluations (`Inf` if not limited).
+   * @param schedule       Population sizes after generations `1, 2, ...` for `REDUCE_SCHEDULE`, the last one holding afterwards.
+   * @param smallest       Smallest population size the DE strategy can work with.
+   */
+  Reduction (ReductionKind kind, int initial, int minimum, int iterations, double maxEvaluations, const std::vector<int>& schedule, int smallest);
+
+  /**
+   * @return Whether the population size may change.
+   */
+  bool enabled () const {
+    return kind != REDUCE_NONE;
+  }
+
+  /**
+   * Gives the population size after a generation.
+   *
+   * @param generation  The generation completed.
+   * @param evaluations Number of evaluations so far.
+   * @param current     The current population size.
+   * @return The population size, at most the current one.
+   */
+  int size (int generation, double evaluations, int current) const;
+
+private:
+  ReductionKind kind;
+  int initial;
+  int minimum;
+  int iterations;
+  double maxEvaluations;
+  std::vector<int> schedule;
+};
+
+#endif
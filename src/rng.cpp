@@ -0,0 +1,180 @@
+#include <cstring>
+#include "rng.h"
+
+RngKind parseRngKind (const std::string& name) {
+  if (name == "R") {
+    return RNG_R;
+  }
+  else if (name == "xoshiro") {
+    return RNG_XOSHIRO;
+  }
+  else if (name == "pcg") {
+#ifdef __SIZEOF_INT128__
+    return RNG_PCG;
+#else
+    Rcpp::stop("PCG64 random number generator is not supported on this platform.");
+#endif
+  }
+  Rcpp::stop("Unknown random number generator: " + name);
+}
+
+
+Random::Random (RngKind kind, uint64_t seed, int stream, int block)
+  : kind(kind),
+    xoshiro(seed, kind == RNG_XOSHIRO ? stream : 0),
+#ifdef __SIZEOF_INT128__
+    pcg(seed, stream),
+#endif
+    uniforms(kind == RNG_R ? 1 : block),
+    normals(kind == RNG_R ? 1 : (block + 1) / 2 * 2),
+    cauchys(kind == RNG_R ? 1 : block),
+    uniformsAt(uniforms.size()),
+    normalsAt(normals.size()),
+    cauchysAt(cauchys.size()) {}
+
+
+uint64_t Random::next () {
+#ifdef __SIZEOF_INT128__
+  if (kind == RNG_PCG) {
+    return pcg.next();
+  }
+#endif
+  return xoshiro.next();
+}
+
+
+double Random::nextUniform () {
+  // Use the upper 53 bits, and avoid exact zero:
+  return ((next() >> 11) + 0.5) * (1.0 / 9007199254740992.0);
+}
+
+
+void Random::fillUniforms () {
+  if (kind == RNG_R) {
+    uniforms[0] = unif_rand();
+  }
+  else {
+    for (size_t i = 0; i < uniforms.size(); i++) {
+      uniforms[i] = nextUniform();
+    }
+  }
+  uniformsAt = 0;
+}
+
+
+void Random::fillNormals () {
+  if (kind == RNG_R) {
+    normals[0] = norm_rand();
+  }
+  else {
+    // Use the Box-Muller transform which yields normals in pairs:
+    for (size_t i = 0; i < normals.size(); i += 2) {
+      const double radius = std::sqrt(-2.0 * std::log(nextUniform()));
+      const double angle = 2.0 * M_PI * nextUniform();
+      normals[i] = radius * std::cos(angle);
+      normals[i + 1] = radius * std::sin(angle);
+    }
+  }
+  normalsAt = 0;
+}
+
+
+void Random::fillCauchys () {
+  if (kind == RNG_R) {
+    cauchys[0] = std::tan(M_PI * unif_rand());
+  }
+  else {
+    for (size_t i = 0; i < cauchys.size(); i++) {
+      cauchys[i] = std::tan(M_PI * nextUniform());
+    }
+  }
+  cauchysAt = 0;
+}
+
+
+void Random::saveState (std::vector<char>& buffer) const {
+  const int32_t fields[4] = { static_cast<int32_t>(kind), static_cast<int32_t>(uniformsAt), static_cast<int32_t>(normalsAt), static_cast<int32_t>(cauchysAt) };
+  const char* engine = kind == RNG_XOSHIRO ? reinterpret_cast<const char*>(&xoshiro) : NULL;
+  size_t engineSize = kind == RNG_XOSHIRO ? sizeof(xoshiro) : 0;
+#ifdef __SIZEOF_INT128__
+  if (kind == RNG_PCG) {
+    engine = reinterpret_cast<const char*>(&pcg);
+    engineSize = sizeof(pcg);
+  }
+#endif
+  buffer.insert(buffer.end(), reinterpret_cast<const char*>(fields), reinterpret_cast<const char*>(fields + 4));
+  buffer.insert(buffer.end(), engine, engine + engineSize);
+  buffer.insert(buffer.end(), reinterpret_cast<const char*>(uniforms.data()), reinterpret_cast<const char*>(uniforms.data() + uniforms.size()));
+  buffer.insert(buffer.end(), reinterpret_cast<const char*>(normals.data()), reinterpret_cast<const char*>(normals.data() + normals.size()));
+  buffer.insert(buffer.end(), reinterpret_cast<const char*>(cauchys.data()), reinterpret_cast<const char*>(cauchys.data() + cauchys.size()));
+}
+
+
+bool Random::loadState (const char* data, size_t size) {
+  // Get the engine:
+  char* engine = kind == RNG_XOSHIRO ? reinterpret_cast<char*>(&xoshiro) : NULL;
+  size_t engineSize = kind == RNG_XOSHIRO ? sizeof(xoshiro) : 0;
+#ifdef __SIZEOF_INT128__
+  if (kind == RNG_PCG) {
+    engine = reinterpret_cast<char*>(&pcg);
+    engineSize = sizeof(pcg);
+  }
+#endif
+
+  // Check the kind and the size:
+  int32_t fields[4];
+  const size_t bufferSize = sizeof(double) * (uniforms.size() + normals.size() + cauchys.size());
+  if (size != sizeof(fields) + engineSize + bufferSize) {
+    return false;
+  }
+  std::memcpy(fields, data, sizeof(fields));
+  if (fields[0] != kind ||
+      fields[1] < 0 || static_cast<size_t>(fields[1]) > uniforms.size() ||
+      fields[2] < 0 || static_cast<size_t>(fields[2]) > normals.size() ||
+      fields[3] < 0 || static_cast<size_t>(fields[3]) > cauchys.size()) {
+    return false;
+  }
+
+  // Restore:
+  data += sizeof(fields);
+  if (engineSize > 0) {
+    std::memcpy(engine, data, engineSize);
+  }
+  data += engineSize;
+  std::memcpy(uniforms.data(), data, sizeof(double) * uniforms.size());
+  data += sizeof(double) * uniforms.size();
+  std::memcpy(normals.data(), data, sizeof(double) * normals.size());
+  data += sizeof(double) * normals.size();
+  std::memcpy(cauchys.data(), data, sizeof(double) * cauchys.size());
+  uniformsAt = fields[1];
+  normalsAt = fields[2];
+  cauchysAt = fields[3];
+  return true;
+}
+
+
+std::vector<Random> createStreams (RngKind kind, uint64_t seed, int count, int block) {
+  std::vector<Random> streams;
+  for (int i = 0; i < count; i++) {
+    streams.push_back(Random(kind, seed, i, block));
+  }
+  return streams;
+}
+
+
+uint64_t drawSeed () {
+  const uint64_t high = static_cast<uint64_t>(unif_rand() * 4294967296.0);
+  const uint64_t low = static_cast<uint64_t>(unif_rand() * 4294967296.0);
+  return (high << 32) | low;
+}
+
+
+uint64_t parseSeed (double seed) {
+  if (ISNAN(seed)) {
+    return drawSeed();
+  }
+  if (!(seed >= 0 && seed < 18446744073709551616.0) || seed != std::floor(seed)) {
+    Rcpp::stop("Seed must be a non-negative integer.");
+  }
+  return static_cast<uint64_t>(seed);
+}
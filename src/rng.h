@@ -0,0 +1,292 @@
+#include <cmath>
+#include <string>
+#include <vector>
+#include <stdint.h>
+#include <Rcpp.h>
+
+#ifndef deflex_rng_h
+#define deflex_rng_h
+
+/**
+ * Provides the xoshiro256++ random number engine.
+ *
+ * See <https://prng.di.unimi.it/>.
+ */
+class Xoshiro256 {
+public:
+  /**
+   * Seeds the engine by expanding the seed with splitmix64, and jumps
+   * ahead by 2^128 steps for each stream to obtain independent streams.
+   *
+   * @param seed   The seed.
+   * @param stream The stream.
+   */
+  Xoshiro256 (uint64_t seed, int stream) {
+    for (int i = 0; i < 4; i++) {
+      seed += 0x9e3779b97f4a7c15ULL;
+      uint64_t z = seed;
+      z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+      z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+      state[i] = z ^ (z >> 31);
+    }
+    for (int i = 0; i < stream; i++) {
+      jump();
+    }
+  }
+
+  /**
+   * @return Next 64-bit output.
+   */
+  inline uint64_t next () {
+    const uint64_t result = rotl(state[0] + state[3], 23) + state[0];
+    const uint64_t t = state[1] << 17;
+    state[2] ^= state[0];
+    state[3] ^= state[1];
+    state[1] ^= state[2];
+    state[0] ^= state[3];
+    state[2] ^= t;
+    state[3] = rotl(state[3], 45);
+    return result;
+  }
+
+  /**
+   * Advances the engine by 2^128 steps.
+   */
+  void jump () {
+    static const uint64_t JUMP[] = { 0x180ec6d33cfd0abaULL, 0xd5a61266f0c9392cULL, 0xa9582618e03fc9aaULL, 0x39abdc4529b1661cULL };
+    uint64_t s[4] = { 0, 0, 0, 0 };
+    for (int i = 0; i < 4; i++) {
+      for (int b = 0; b < 64; b++) {
+        if (JUMP[i] & (1ULL << b)) {
+          for (int k = 0; k < 4; k++) {
+            s[k] ^= state[k];
+          }
+        }
+        next();
+      }
+    }
+    for (int k = 0; k < 4; k++) {
+      state[k] = s[k];
+    }
+  }
+
+private:
+  static inline uint64_t rotl (const uint64_t x, int k) {
+    return (x << k) | (x >> (64 - k));
+  }
+
+  uint64_t state[4];
+};
+
+
+#ifdef __SIZEOF_INT128__
+/**
+ * Unsigned 128-bit integer of the PCG64 engine state (`__extension__`
+ * keeps pedantic compilers quiet about the non-standard type).
+ */
+__extension__ typedef unsigned __int128 pcg128;
+
+
+/**
+ * Provides the PCG64 (XSL RR 128/64) random number engine.
+ *
+ * See <https://www.pcg-random.org/>.
+ */
+class Pcg64 {
+public:
+  /**
+   * Seeds the engine. Each stream uses its own increment to obtain
+   * independent streams.
+   *
+   * @param seed   The seed.
+   * @param stream The stream.
+   */
+  Pcg64 (uint64_t seed, int stream) : state(0), increment((static_cast<pcg128>(stream) << 1) | 1) {
+    next();
+    state += seed;
+    next();
+  }
+
+  /**
+   * @return Next 64-bit output.
+   */
+  inline uint64_t next () {
+    const pcg128 multiplier = (static_cast<pcg128>(0x2360ed051fc65da4ULL) << 64) | 0x4385df649fccf645ULL;
+    state = state * multiplier + increment;
+    const uint64_t value = static_cast<uint64_t>(state >> 64) ^ static_cast<uint64_t>(state);
+    const int rotation = static_cast<int>(state >> 122);
+    return (value >> rotation) | (value << ((-rotation) & 63));
+  }
+
+private:
+  pcg128 state;
+  pcg128 increment;
+};
+#endif
+
+
+/**
+ * Enumerates random number generators.
+ */
+enum RngKind {
+  /**
+   * R's random number generator.
+   */
+  RNG_R,
+
+  /**
+   * xoshiro256++ engine.
+   */
+  RNG_XOSHIRO,
+
+  /**
+   * PCG64 engine.
+   */
+  RNG_PCG
+};
+
+
+/**
+ * Parses the random number generator kind.
+ *
+ * @param name One of `"R"`, `"xoshiro"` or `"pcg"`.
+ * @return The random number generator kind.
+ */
+RngKind parseRngKind (const std::string& name);
+
+
+/**
+ * Provides uniform, normal and Cauchy random numbers.
+ *
+ * Numbers are served from buffers. With the internal engines, each
+ * buffer is refilled in bulk once exhausted. With R's random number
+ * generator, buffers hold a single number drawn on demand, so that the
+ * sequence of draws from R is the same as calling `Rf_runif`,
+ * `Rf_rnorm` and `Rf_rcauchy` directly. R's random number generator
+ * must only be used from the main thread whereas the internal engines
+ * do not touch R and can be used from worker threads, one instance per
+ * thread.
+ */
+class Random {
+public:
+  /**
+   * @param kind   Random number generator kind.
+   * @param seed   The seed (ignored for R's random number generator).
+   * @param stream The stream (ignored for R's random number generator).
+   * @param block  Number of uniform random numbers to fill in bulk.
+   */
+  Random (RngKind kind, uint64_t seed, int stream, int block);
+
+  /**
+   * @return An observation from Uniform(0, 1).
+   */
+  inline double unif () {
+    if (uniformsAt == uniforms.size()) {
+      fillUniforms();
+    }
+    return uniforms[uniformsAt++];
+  }
+
+  /**
+   * @param mu Mean.
+   * @param sd Standard deviation.
+   * @return An observation from Normal(mu, sd).
+   */
+  inline double norm (double mu, double sd) {
+    if (normalsAt == normals.size()) {
+      fillNormals();
+    }
+    return mu + sd * normals[normalsAt++];
+  }
+
+  /**
+   * @param location Location.
+   * @param scale    Scale.
+   * @return An observation from Cauchy(location, scale).
+   */
+  inline double cauchy (double location, double scale) {
+    if (cauchysAt == cauchys.size()) {
+      fillCauchys();
+    }
+    return location + scale * cauchys[cauchysAt++];
+  }
+
+  /**
+   * @param n The upper bound (exclusive).
+   * @return An observation from the uniform distribution over integers `[0, n)`.
+   */
+  inline int index (int n) {
+    // Same as `Rcpp::sample(n, 1)[0] - 1` for R's random number generator:
+    return static_cast<int>(n * unif());
+  }
+
+  /**
+   * Appends the state, ie. the engine state along with the buffered
+   * numbers, to a byte buffer.
+   *
+   * The state of R's random number generator is not included as it is
+   * kept by R.
+   *
+   * @param buffer The buffer.
+   */
+  void saveState (std::vector<char>& buffer) const;
+
+  /**
+   * Restores the state saved by `saveState` for the same kind and block.
+   *
+   * @param data The saved state.
+   * @param size Size of the saved state in bytes.
+   * @return Whether the state is restored, ie. it matches this generator.
+   */
+  bool loadState (const char* data, size_t size);
+
+private:
+  uint64_t next ();
+  double nextUniform ();
+  void fillUniforms ();
+  void fillNormals ();
+  void fillCauchys ();
+
+  RngKind kind;
+  Xoshiro256 xoshiro;
+#ifdef __SIZEOF_INT128__
+  Pcg64 pcg;
+#endif
+  std::vector<double> uniforms;
+  std::vector<double> normals;
+  std::vector<double> cauchys;
+  size_t uniformsAt;
+  size_t normalsAt;
+  size_t cauchysAt;
+};
+
+
+/**
+ * Creates independent random number streams from a single seed.
+ *
+ * @param kind  Random number generator kind.
+ * @param seed  The seed.
+ * @param count Number of streams.
+ * @param block Number of uniform random numbers to fill in bulk.
+ * @return Streams.
+ */
+std::vector<Random> createStreams (RngKind kind, uint64_t seed, int count, int block);
+
+
+/**
+ * Draws a 64-bit seed from R's random number generator.
+ *
+ * @return The seed.
+ */
+uint64_t drawSeed ();
+
+
+/**
+ * Parses a seed given as a double, or draws one if missing.
+ *
+ * @param seed The seed, a non-negative integer, or `NA` to draw it from R's random number generator (see `drawSeed`).
+ * @return The seed.
+ */
+uint64_t parseSeed (double seed);
+
+#endif
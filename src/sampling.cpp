@@ -0,0 +1,282 @@
+#include <algorithm>
+#include <Rcpp.h>
+#include "sampling.h"
+
+SamplingKind parseSampling (const std::string& name) {
+  if (name == "uniform") {
+    return SAMPLING_UNIFORM;
+  }
+  else if (name == "lhs") {
+    return SAMPLING_LHS;
+  }
+  else if (name == "halton") {
+    return SAMPLING_HALTON;
+  }
+  else if (name == "sobol") {
+    return SAMPLING_SOBOL;
+  }
+  Rcpp::stop("Unknown initial population generator: " + name);
+}
+
+
+/**
+ * Number of bits of Sobol points.
+ */
+static const int SOBOL_BITS = 32;
+
+
+/**
+ * Multiplies two polynomials over GF(2) modulo a polynomial.
+ *
+ * @param a      First factor of degree less than `degree`.
+ * @param b      Second factor of degree less than `degree`.
+ * @param p      The modulus.
+ * @param degree Degree of the modulus.
+ * @return The product.
+ */
+static uint64_t multiplyModulo (uint64_t a, uint64_t b, uint64_t p, int degree) {
+  uint64_t retval = 0;
+  for (; b != 0; b >>= 1) {
+    if (b & 1) {
+      retval ^= a;
+    }
+    a <<= 1;
+    if (a & (1ULL << degree)) {
+      a ^= p;
+    }
+  }
+  return retval;
+}
+
+
+/**
+ * Raises `x` to a power modulo a polynomial over GF(2).
+ *
+ * @param exponent The exponent.
+ * @param p        The modulus.
+ * @param degree   Degree of the modulus.
+ * @return The power.
+ */
+static uint64_t powerModulo (uint64_t exponent, uint64_t p, int degree) {
+  uint64_t retval = 1;
+  uint64_t base = 2;
+  if (base & (1ULL << degree)) {
+    base ^= p;
+  }
+  for (; exponent != 0; exponent >>= 1) {
+    if (exponent & 1) {
+      retval = multiplyModulo(retval, base, p, degree);
+    }
+    base = multiplyModulo(base, base, p, degree);
+  }
+  return retval;
+}
+
+
+/**
+ * Enumerates primitive polynomials over GF(2), lowest degrees first.
+ *
+ * A polynomial of degree `s` is primitive if `x` is of order `2^s - 1`
+ * modulo the polynomial, ie. `x^(2^s - 1) = 1` and `x^((2^s - 1) / q) != 1`
+ * for each prime factor `q` of `2^s - 1`.
+ *
+ * @param count   Number of polynomials.
+ * @param degrees Degrees of the polynomials (output).
+ * @return Polynomials, each coefficient a bit.
+ */
+static std::vector<uint64_t> primitivePolynomials (int count, std::vector<int>& degrees) {
+  std::vector<uint64_t> retval;
+  for (int s = 1; static_cast<int>(retval.size()) < count && s < 63; s++) {
+    // Factorise the order of the multiplicative group:
+    const uint64_t order = (1ULL << s) - 1;
+    std::vector<uint64_t> factors;
+    uint64_t rest = order;
+    for (uint64_t q = 3; q * q <= rest; q += 2) {
+      if (rest % q == 0) {
+        factors.push_back(q);
+        while (rest % q == 0) {
+          rest /= q;
+        }
+      }
+    }
+    if (rest > 1) {
+      factors.push_back(rest);
+    }
+
+    // Test polynomials with both leading and constant terms:
+    for (uint64_t p = (1ULL << s) | 1; p < (2ULL << s) && static_cast<int>(retval.size()) < count; p += 2) {
+      bool primitive = powerModulo(order, p, s) == 1;
+      for (size_t k = 0; primitive && k < factors.size(); k++) {
+        primitive = powerModulo(order / factors[k], p, s) != 1;
+      }
+      if (primitive) {
+        retval.push_back(p);
+        degrees.push_back(s);
+      }
+    }
+  }
+  return retval;
+}
+
+
+/**
+ * Generates the unit Sobol population.
+ *
+ * The first parameter is the van der Corput sequence, each following
+ * one uses the next primitive polynomial with random odd initial
+ * direction numbers `m_k < 2^k`. Points are generated in Gray code
+ * order, and each parameter is scrambled with a random digital shift.
+ */
+static void sampleSobol (int popsize, int dimension, Random& rng, double* matrix) {
+  // Find the primitive polynomials:
+  std::vector<int> degrees;
+  const std::vector<uint64_t> polynomials = primitivePolynomials(dimension - 1, degrees);
+
+  // Compute direction numbers, bit by bit for all parameters:
+  std::vector<uint32_t> directions(static_cast<size_t>(SOBOL_BITS) * dimension);
+  std::vector<uint64_t> m(SOBOL_BITS + 1);
+  for (int j = 0; j < dimension; j++) {
+    for (int k = 1; k <= SOBOL_BITS; k++) {
+      if (j == 0) {
+        m[k] = 1;
+      }
+      else if (k <= degrees[j - 1]) {
+        m[k] = 2 * static_cast<uint64_t>(rng.unif() * (1ULL << (k - 1))) + 1;
+      }
+      else {
+        const int s = degrees[j - 1];
+        m[k] = m[k - s] ^ (m[k - s] << s);
+        for (int i = 1; i < s; i++) {
+          if ((polynomials[j - 1] >> (s - i)) & 1) {
+            m[k] ^= m[k - i] << i;
+          }
+        }
+      }
+      directions[static_cast<size_t>(k - 1) * dimension + j] = static_cast<uint32_t>(m[k] << (SOBOL_BITS - k));
+    }
+  }
+
+  // Draw digital shifts:
+  std::vector<uint32_t> point(dimension);
+  for (int j = 0; j < dimension; j++) {
+    point[j] = static_cast<uint32_t>(rng.unif() * 4294967296.0);
+  }
+
+  // Generate points, each from the previous one by the direction of the lowest zero bit of its index:
+  for (int i = 0; i < popsize; i++) {
+    if (i > 0) {
+      int bit = 0;
+      for (unsigned int n = i - 1; n & 1; n >>= 1) {
+        bit++;
+      }
+      const uint32_t* direction = directions.data() + static_cast<size_t>(bit) * dimension;
+      for (int j = 0; j < dimension; j++) {
+        point[j] ^= direction[j];
+      }
+    }
+    for (int j = 0; j < dimension; j++) {
+      matrix[i + static_cast<size_t>(j) * popsize] = (point[j] + 0.5) / 4294967296.0;
+    }
+  }
+}
+
+
+/**
+ * Generates the unit Halton population.
+ *
+ * Each parameter uses the radical inverse in the next prime base, with
+ * its digits permuted by a random multiplier modulo the base. Points
+ * start at index 1 to avoid the origin.
+ */
+static void sampleHalton (int popsize, int dimension, Random& rng, double* matrix) {
+  // Find the first primes:
+  std::vector<int> primes;
+  for (int n = 2; static_cast<int>(primes.size()) < dimension; n++) {
+    bool prime = true;
+    for (size_t k = 0; prime && k < primes.size() && primes[k] * primes[k] <= n; k++) {
+      prime = n % primes[k] != 0;
+    }
+    if (prime) {
+      primes.push_back(n);
+    }
+  }
+
+  // Generate points parameter by parameter:
+  for (int j = 0; j < dimension; j++) {
+    const int base = primes[j];
+    const uint64_t multiplier = 1 + rng.index(base - 1);
+    double* column = matrix + static_cast<size_t>(j) * popsize;
+    for (int i = 0; i < popsize; i++) {
+      double value = 0;
+      double weight = 1.0 / base;
+      for (int n = i + 1; n > 0; n /= base) {
+        value += static_cast<double>((multiplier * (n % base)) % base) * weight;
+        weight /= base;
+      }
+      column[i] = value;
+    }
+  }
+}
+
+
+/**
+ * Generates the unit Latin hypercube population.
+ *
+ * Each parameter uses its own random permutation of the slices, and a
+ * uniform draw within each slice.
+ */
+static void sampleLhs (int popsize, int dimension, Random& rng, double* matrix) {
+  std::vector<int> slices(popsize);
+  for (int j = 0; j < dimension; j++) {
+    // Shuffle the slices:
+    for (int i = 0; i < popsize; i++) {
+      slices[i] = i;
+    }
+    for (int i = popsize - 1; i > 0; i--) {
+      std::swap(slices[i], slices[rng.index(i + 1)]);
+    }
+
+    // Draw within each slice:
+    double* column = matrix + static_cast<size_t>(j) * popsize;
+    for (int i = 0; i < popsize; i++) {
+      column[i] = (slices[i] + rng.unif()) / popsize;
+    }
+  }
+}
+
+
+void samplePopulation (SamplingKind kind,
+                       int popsize,
+                       int dimension,
+                       const double* lower,
+                       const double* upper,
+                       uint64_t seed,
+                       double* matrix) {
+  // Generate the population in the unit hypercube:
+  Random rng(RNG_XOSHIRO, seed, 0, 256);
+  switch (kind) {
+  case SAMPLING_UNIFORM:
+    for (size_t k = 0; k < static_cast<size_t>(popsize) * dimension; k++) {
+      matrix[k] = rng.unif();
+    }
+    break;
+  case SAMPLING_LHS:
+    sampleLhs(popsize, dimension, rng, matrix);
+    break;
+  case SAMPLING_HALTON:
+    sampleHalton(popsize, dimension, rng, matrix);
+    break;
+  case SAMPLING_SOBOL:
+    sampleSobol(popsize, dimension, rng, matrix);
+    break;
+  }
+
+  // Scale to the bounds:
+  for (int j = 0; j < dimension; j++) {
+    double* column = matrix + static_cast<size_t>(j) * popsize;
+    const double width = upper[j] - lower[j];
+    for (int i = 0; i < popsize; i++) {
+      column[i] = lower[j] + column[i] * width;
+    }
+  }
+}
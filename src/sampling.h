@@ -0,0 +1,71 @@
+#include <string>
+#include <vector>
+#include <stdint.h>
+#include "rng.h"
+
+#ifndef deflex_sampling_h
+#define deflex_sampling_h
+
+/**
+ * Enumerates the generators of initial populations.
+ */
+enum SamplingKind {
+  /**
+   * Independent uniform draws within the bounds.
+   */
+  SAMPLING_UNIFORM,
+
+  /**
+   * Latin hypercube, ie. one member in each of `popsize` equal slices
+   * of each parameter.
+   */
+  SAMPLING_LHS,
+
+  /**
+   * Halton sequence with random linear digit scrambling.
+   */
+  SAMPLING_HALTON,
+
+  /**
+   * Sobol sequence with random direction numbers and digital shifts.
+   */
+  SAMPLING_SOBOL
+};
+
+
+/**
+ * Parses the generator of initial populations.
+ *
+ * @param name One of `"uniform"`, `"lhs"`, `"halton"` or `"sobol"`.
+ * @return The generator.
+ */
+SamplingKind parseSampling (const std::string& name);
+
+
+/**
+ * Generates an initial population within bounds.
+ *
+ * Members are generated in the unit hypercube directly in the output
+ * matrix, and scaled to the bounds in place. The Sobol sequence
+ * supports up to 2^32 members and any dimension, its primitive
+ * polynomials being enumerated as needed. The Halton sequence degrades
+ * in high dimensions, where the Sobol sequence or Latin hypercubes are
+ * to be preferred.
+ *
+ * @param kind      The generator.
+ * @param popsize   Population size.
+ * @param dimension Problem dimension.
+ * @param lower     Lower-bounds.
+ * @param upper     Upper-bounds.
+ * @param seed      The seed for scrambling.
+ * @param matrix    The population as a column-major matrix of `popsize` rows and `dimension` columns (output).
+ */
+void samplePopulation (SamplingKind kind,
+                       int popsize,
+                       int dimension,
+                       const double* lower,
+                       const double* upper,
+                       uint64_t seed,
+                       double* matrix);
+
+#endif
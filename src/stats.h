@@ -0,0 +1,210 @@
+#include <chrono>
+#include <vector>
+#include <Rcpp.h>
+
+#ifndef deflex_stats_h
+#define deflex_stats_h
+
+/**
+ * Provides the phases of a generation which are timed.
+ */
+enum Phase {
+  /**
+   * Adjusting CR and F.
+   */
+  PHASE_ADAPTATION,
+
+  /**
+   * Copying the candidate, picking donors and the starting element.
+   */
+  PHASE_DONORS,
+
+  /**
+   * Mutation and crossover.
+   */
+  PHASE_MUTATION,
+
+  /**
+   * Precision and bounds repair.
+   */
+  PHASE_REPAIR,
+
+  /**
+   * Evaluating trials.
+   */
+  PHASE_EVALUATION,
+
+  /**
+   * Selection, adaptation of mean CR and F, and history copying.
+   */
+  PHASE_BOOKKEEPING,
+
+  /**
+   * Number of phases.
+   */
+  PHASE_COUNT
+};
+
+
+/**
+ * Provides the probe which collects nothing.
+ *
+ * All its members are empty and inlined, hence instrumented code
+ * compiles to the same as uninstrumented code with it.
+ */
+struct NoStats {
+  /**
+   * Provides the point in time a phase is timed from.
+   */
+  struct Mark {};
+
+  /**
+   * @return The current point in time.
+   */
+  Mark mark () const {
+    return Mark();
+  }
+
+  /**
+   * Adds the time since the mark to the phase and moves the mark to now.
+   */
+  void lap (Phase, Mark&) {}
+
+  /**
+   * Counts objective function calls.
+   */
+  void calls (double) {}
+
+  /**
+   * Counts trials which replaced their candidates.
+   */
+  void replacements (int) {}
+
+  /**
+   * Counts NaN elements repaired in the mutation.
+   */
+  void nanRepairs (int) {}
+
+  /**
+   * Counts elements of a trial below and above bounds, before repair.
+   */
+  void bounds (const double*, const double*, const double*, int) {}
+
+  /**
+   * Counts a bounce-back.
+   */
+  void bounceBack () {}
+
+  /**
+   * Records the wall-clock time of a generation started at the mark.
+   */
+  void generation (const Mark&) {}
+
+  /**
+   * Adds the statistics of another probe.
+   */
+  void merge (const NoStats&) {}
+
+  /**
+   * @return `NULL`.
+   */
+  SEXP report () const {
+    return R_NilValue;
+  }
+};
+
+
+/**
+ * Provides the probe which times phases on the monotonic clock and
+ * counts events. Phase times of multi-threaded runs are summed over
+ * threads.
+ */
+struct Stats {
+  typedef std::chrono::steady_clock::time_point Mark;
+
+  Stats () : callCount(0), replacementCount(0), nanRepairCount(0), lowerHitCount(0), upperHitCount(0), bounceBackCount(0) {
+    for (int i = 0; i < PHASE_COUNT; i++) {
+      seconds[i] = 0;
+    }
+  }
+
+  Mark mark () const {
+    return std::chrono::steady_clock::now();
+  }
+
+  void lap (Phase phase, Mark& mark) {
+    const Mark now = std::chrono::steady_clock::now();
+    seconds[phase] += std::chrono::duration<double>(now - mark).count();
+    mark = now;
+  }
+
+  void calls (double count) {
+    callCount += count;
+  }
+
+  void replacements (int count) {
+    replacementCount += count;
+  }
+
+  void nanRepairs (int count) {
+    nanRepairCount += count;
+  }
+
+  void bounds (const double* trial, const double* lower, const double* upper, int dimension) {
+    for (int i = 0; i < dimension; i++) {
+      lowerHitCount += trial[i] < lower[i];
+      upperHitCount += trial[i] > upper[i];
+    }
+  }
+
+  void bounceBack () {
+    bounceBackCount++;
+  }
+
+  void generation (const Mark& start) {
+    generationSeconds.push_back(std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+  }
+
+  void merge (const Stats& other) {
+    for (int i = 0; i < PHASE_COUNT; i++) {
+      seconds[i] += other.seconds[i];
+    }
+    callCount += other.callCount;
+    replacementCount += other.replacementCount;
+    nanRepairCount += other.nanRepairCount;
+    lowerHitCount += other.lowerHitCount;
+    upperHitCount += other.upperHitCount;
+    bounceBackCount += other.bounceBackCount;
+  }
+
+  /**
+   * @return The phase times in seconds, the counters and the wall-clock
+   *         time of each generation in seconds.
+   */
+  SEXP report () const {
+    return Rcpp::List::create(Rcpp::_["adaptation"] = seconds[PHASE_ADAPTATION],
+                              Rcpp::_["donors"] = seconds[PHASE_DONORS],
+                              Rcpp::_["mutation"] = seconds[PHASE_MUTATION],
+                              Rcpp::_["repair"] = seconds[PHASE_REPAIR],
+                              Rcpp::_["evaluation"] = seconds[PHASE_EVALUATION],
+                              Rcpp::_["bookkeeping"] = seconds[PHASE_BOOKKEEPING],
+                              Rcpp::_["calls"] = callCount,
+                              Rcpp::_["replacements"] = replacementCount,
+                              Rcpp::_["nanrepairs"] = nanRepairCount,
+                              Rcpp::_["lowerhits"] = lowerHitCount,
+                              Rcpp::_["upperhits"] = upperHitCount,
+                              Rcpp::_["bouncebacks"] = bounceBackCount,
+                              Rcpp::_["generations"] = Rcpp::wrap(generationSeconds));
+  }
+
+  double seconds[PHASE_COUNT];
+  double callCount;
+  double replacementCount;
+  double nanRepairCount;
+  double lowerHitCount;
+  double upperHitCount;
+  double bounceBackCount;
+  std::vector<double> generationSeconds;
+};
+
+#endif
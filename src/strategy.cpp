@@ -0,0 +1,61 @@
+#include <Rcpp.h>
+#include "strategy.h"
+
+Mutation parseMutation (const std::string& name) {
+  if (name == "best/1") {
+    return MUTATION_BEST1;
+  }
+  else if (name == "rand/1") {
+    return MUTATION_RAND1;
+  }
+  else if (name == "current-to-best/1") {
+    return MUTATION_CURRENT_TO_BEST1;
+  }
+  else if (name == "rand/2") {
+    return MUTATION_RAND2;
+  }
+  Rcpp::stop("Unknown mutation scheme: " + name);
+}
+
+
+Crossover parseCrossover (const std::string& name) {
+  if (name == "exponential") {
+    return CROSSOVER_EXPONENTIAL;
+  }
+  else if (name == "binomial") {
+    return CROSSOVER_BINOMIAL;
+  }
+  Rcpp::stop("Unknown crossover scheme: " + name);
+}
+
+
+Boundary parseBoundary (const std::string& name, bool bounceBack) {
+  if (name.empty()) {
+    return bounceBack ? BOUNDARY_BOUNCE_BACK : BOUNDARY_CLAMP;
+  }
+  else if (name == "clamp") {
+    return BOUNDARY_CLAMP;
+  }
+  else if (name == "bounce") {
+    return BOUNDARY_BOUNCE_BACK;
+  }
+  else if (name == "reflect") {
+    return BOUNDARY_REFLECT;
+  }
+  else if (name == "midpoint") {
+    return BOUNDARY_MIDPOINT;
+  }
+  Rcpp::stop("Unknown boundary handling scheme: " + name);
+}
+
+
+int donorCount (Mutation mutation) {
+  switch (mutation) {
+  case MUTATION_RAND1:
+    return 3;
+  case MUTATION_RAND2:
+    return 5;
+  default:
+    return 2;
+  }
+}
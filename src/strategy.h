@@ -0,0 +1,116 @@
+#include <string>
+
+#ifndef deflex_strategy_h
+#define deflex_strategy_h
+
+/**
+ * Enumerates mutation schemes, where `F` is the differential weighting
+ * factor (with jitter), `best` the best member, `current` the candidate
+ * and `r1` to `r5` distinct random donors other than the candidate.
+ */
+enum Mutation {
+  /**
+   * `best + F * (r1 - r2)`.
+   */
+  MUTATION_BEST1,
+
+  /**
+   * `r1 + F * (r2 - r3)`.
+   */
+  MUTATION_RAND1,
+
+  /**
+   * `current + F * (best - current) + F * (r1 - r2)`.
+   */
+  MUTATION_CURRENT_TO_BEST1,
+
+  /**
+   * `r1 + F * (r2 - r3) + F * (r4 - r5)`.
+   */
+  MUTATION_RAND2
+};
+
+
+/**
+ * Enumerates crossover schemes.
+ */
+enum Crossover {
+  /**
+   * Takes a run of mutant elements, starting at a random element and
+   * continuing with probability CR (wrapping around).
+   */
+  CROSSOVER_EXPONENTIAL,
+
+  /**
+   * Takes each mutant element with probability CR, and one random
+   * element at least.
+   */
+  CROSSOVER_BINOMIAL
+};
+
+
+/**
+ * Enumerates boundary handling schemes for elements out of bounds.
+ */
+enum Boundary {
+  /**
+   * Sets the element to the violated bound.
+   */
+  BOUNDARY_CLAMP,
+
+  /**
+   * Draws the element randomly (see `BoundaryBounceBack`).
+   */
+  BOUNDARY_BOUNCE_BACK,
+
+  /**
+   * Mirrors the element at the violated bound, clamping if it is still
+   * out of bounds.
+   */
+  BOUNDARY_REFLECT,
+
+  /**
+   * Sets the element to the midpoint of the violated bound and the
+   * candidate's element.
+   */
+  BOUNDARY_MIDPOINT
+};
+
+
+/**
+ * Parses the mutation scheme.
+ *
+ * @param name One of `"best/1"`, `"rand/1"`, `"current-to-best/1"` or `"rand/2"`.
+ * @return The mutation scheme.
+ */
+Mutation parseMutation (const std::string& name);
+
+
+/**
+ * Parses the crossover scheme.
+ *
+ * @param name One of `"exponential"` or `"binomial"`.
+ * @return The crossover scheme.
+ */
+Crossover parseCrossover (const std::string& name);
+
+
+/**
+ * Parses the boundary handling scheme.
+ *
+ * @param name       One of `"clamp"`, `"bounce"`, `"reflect"` or `"midpoint"`, or `""` to use `bounceBack`.
+ * @param bounceBack Whether to bounce back from boundaries or clamp, if the name is empty.
+ * @return The boundary handling scheme.
+ */
+Boundary parseBoundary (const std::string& name, bool bounceBack);
+
+
+/**
+ * Gives the number of random donors a mutation scheme picks.
+ *
+ * @param mutation The mutation scheme.
+ * @return Number of donors.
+ */
+int donorCount (Mutation mutation);
+
+#endif
@@ -0,0 +1,126 @@
+#include <cmath>
+#include <limits>
+#include <algorithm>
+#include <Rcpp.h>
+#include "surrogate.h"
+
+SurrogateKind parseSurrogate (const std::string& name) {
+  if (name == "none") {
+    return SURROGATE_NONE;
+  }
+  else if (name == "knn") {
+    return SURROGATE_KNN;
+  }
+  Rcpp::stop("Unknown surrogate model: " + name);
+}
+
+
+Surrogate::Surrogate (int dimension, const double* lower, const double* upper, int neighbours, int capacity, double exploration)
+  : dimension(dimension), neighbours(neighbours), capacity(capacity), exploration(exploration),
+    scale(dimension), points(static_cast<size_t>(capacity) * dimension), values(capacity), count(0), next(0), buffer(dimension) {
+  // Check the settings:
+  if (neighbours < 1 || capacity <= neighbours) {
+    Rcpp::stop("Surrogate capacity must exceed its number of neighbours, which must be positive.");
+  }
+  if (exploration < 0 || exploration > 1) {
+    Rcpp::stop("Surrogate exploration must be between 0 and 1.");
+  }
+
+  // Scale parameters by the width of their bounds:
+  for (int j = 0; j < dimension; j++) {
+    const double width = upper[j] - lower[j];
+    scale[j] = width > 0 ? 1 / width : 1;
+  }
+}
+
+
+void Surrogate::learn (const Population& points, const std::vector<double>& scores, const char* screened) {
+  for (int i = 0; i < points.size(); i++) {
+    // Skip points not evaluated, infeasible, or out of bounds:
+    if ((screened != NULL && screened[i]) || !std::isfinite(scores[i])) {
+      continue;
+    }
+
+    // Keep the scaled point in place of the oldest one:
+    const double* point = points.row(i, buffer.data());
+    double* slot = this->points.data() + static_cast<size_t>(next) * dimension;
+    for (int j = 0; j < dimension; j++) {
+      slot[j] = point[j] * scale[j];
+    }
+    values[next] = scores[i];
+    next = (next + 1) % capacity;
+    count = std::min(count + 1, capacity);
+  }
+}
+
+
+double Surrogate::predict (const double* point, double& distance) {
+  // Compute squared distances to all kept points:
+  nearest.resize(count);
+  for (int k = 0; k < count; k++) {
+    const double* kept = points.data() + static_cast<size_t>(k) * dimension;
+    double sum = 0;
+    for (int j = 0; j < dimension; j++) {
+      const double delta = point[j] * scale[j] - kept[j];
+      sum += delta * delta;
+    }
+    nearest[k] = std::make_pair(sum, k);
+  }
+
+  // Find the nearest points:
+  const int k = std::min(neighbours, count);
+  std::partial_sort(nearest.begin(), nearest.begin() + k, nearest.end());
+  distance = std::sqrt(nearest[0].first);
+
+  // An evaluated point predicts itself:
+  if (nearest[0].first == 0) {
+    return values[nearest[0].second];
+  }
+
+  // Weigh the nearest points by their inverse distances:
+  double weights = 0;
+  double sum = 0;
+  for (int i = 0; i < k; i++) {
+    const double weight = 1 / std::sqrt(nearest[i].first);
+    weights += weight;
+    sum += weight * values[nearest[i].second];
+  }
+  return sum / weights;
+}
+
+
+int Surrogate::screen (const Population& trials,
+                       const std::vector<double>& scores,
+                       std::vector<double>& trialScores,
+                       std::vector<double>& trialViolations,
+                       std::vector<char>& screened) {
+  // Wait until enough points are kept:
+  if (count <= neighbours) {
+    return 0;
+  }
+
+  // Find trials predicted not to improve on their candidates, along with their distances to known points:
+  std::vector<std::pair<double, int> > unpromising;
+  for (int i = 0; i < trials.size(); i++) {
+    if (screened[i]) {
+      continue;
+    }
+    double distance;
+    if (predict(trials.row(i, buffer.data()), distance) >= scores[i]) {
+      unpromising.push_back(std::make_pair(-distance, i));
+    }
+  }
+
+  // Keep the exploration quota, the least known trials first, and skip the others:
+  const int quota = std::ceil(exploration * unpromising.size());
+  std::stable_sort(unpromising.begin(), unpromising.end());
+  for (size_t k = quota; k < unpromising.size(); k++) {
+    const int i = unpromising[k].second;
+    screened[i] = 1;
+    trialScores[i] = std::numeric_limits<double>::infinity();
+    trialViolations[i] = std::numeric_limits<double>::infinity();
+  }
+
+  // Done, return:
+  return unpromising.size() - quota;
+}
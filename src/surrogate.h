@@ -0,0 +1,111 @@
+#include <string>
+#include <vector>
+#include "population.h"
+
+#ifndef deflex_surrogate_h
+#define deflex_surrogate_h
+
+/**
+ * Enumerates the surrogate models to pre-screen trials with.
+ */
+enum SurrogateKind {
+  /**
+   * Evaluates all trials.
+   */
+  SURROGATE_NONE,
+
+  /**
+   * Predicts scores by the inverse-distance weighted mean of the
+   * nearest evaluated points.
+   */
+  SURROGATE_KNN
+};
+
+
+/**
+ * Parses the surrogate model.
+ *
+ * @param name One of `"none"` or `"knn"`.
+ * @return The surrogate model.
+ */
+SurrogateKind parseSurrogate (const std::string& name);
+
+
+/**
+ * Provides a k-nearest-neighbours regressor of the objective function,
+ * trained incrementally on the points evaluated so far, to skip trials
+ * which are predicted not to improve on their candidates.
+ *
+ * Points are kept in a ring buffer of fixed capacity, so that the
+ * oldest points give way to the ones around the converging population.
+ * Distances are measured with each parameter scaled by the width of its
+ * bounds.
+ */
+class Surrogate {
+public:
+  /**
+   * @param dimension   Problem dimension.
+   * @param lower       Lower-bounds.
+   * @param upper       Upper-bounds.
+   * @param neighbours  Number of nearest points to predict from.
+   * @param capacity    Maximum number of points kept.
+   * @param exploration Fraction of the trials predicted not to improve which are evaluated nevertheless, the least known first.
+   */
+  Surrogate (int dimension, const double* lower, const double* upper, int neighbours, int capacity, double exploration);
+
+  /**
+   * Keeps the feasible points with finite scores, ie. neither skipped,
+   * out of bounds, nor screened out by the constraint function, whose
+   * scores are penalties rather than objective values.
+   *
+   * @param points   The points.
+   * @param scores   The point scores.
+   * @param screened Flags of points screened out, which are not kept (`NULL` if none).
+   */
+  void learn (const Population& points, const std::vector<double>& scores, const char* screened);
+
+  /**
+   * Predicts the score of a point.
+   *
+   * @param point    The point.
+   * @param distance Scaled distance to the nearest kept point (output).
+   * @return The predicted score.
+   */
+  double predict (const double* point, double& distance);
+
+  /**
+   * Skips trials predicted not to improve on their candidates, but the
+   * exploration quota.
+   *
+   * Skipped trials score and violate infinitely, so that they never
+   * replace their candidates. Nothing is skipped until enough points
+   * are kept.
+   *
+   * @param trials          Trials.
+   * @param scores          The candidate scores.
+   * @param trialScores     The trial scores (output).
+   * @param trialViolations The trial constraint violations (output).
+   * @param screened        Flags of trials not to evaluate, already set for infeasible ones (output).
+   * @return Number of trials skipped.
+   */
+  int screen (const Population& trials,
+              const std::vector<double>& scores,
+              std::vector<double>& trialScores,
+              std::vector<double>& trialViolations,
+              std::vector<char>& screened);
+
+private:
+  int dimension;
+  int neighbours;
+  int capacity;
+  double exploration;
+  std::vector<double> scale;
+  std::vector<double> points;
+  std::vector<double> values;
+  int count;
+  int next;
+  std::vector<std::pair<double, int> > nearest;
+  std::vector<double> buffer;
+};
+
+#endif
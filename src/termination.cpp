@@ -0,0 +1,100 @@
+#include <limits>
+#include <algorithm>
+#include "termination.h"
+
+const char* criterionName (Criterion criterion) {
+  switch (criterion) {
+  case TERMINATE_TARGET:
+    return "target";
+  case TERMINATE_STAGNATION:
+    return "stagnation";
+  case TERMINATE_SCORE_TOLERANCE:
+    return "scoreTolerance";
+  case TERMINATE_PARAMETER_TOLERANCE:
+    return "parameterTolerance";
+  case TERMINATE_EVALUATIONS:
+    return "evaluations";
+  case TERMINATE_DEADLINE:
+    return "deadline";
+  default:
+    return "iterations";
+  }
+}
+
+
+Termination::Termination (double target, int stagnation, double scoreTolerance, double parameterTolerance, double maxEvaluations, double timeLimit)
+  : target(target), stagnation(stagnation), scoreTolerance(scoreTolerance), parameterTolerance(parameterTolerance),
+    maxEvaluations(maxEvaluations), timeLimit(timeLimit), start(std::chrono::steady_clock::now()),
+    lastBestScore(0), stagnant(0), checked(false) {}
+
+
+Criterion Termination::check (const Population& population, const std::vector<double>& scores, double bestScore, double evaluations) {
+  count(bestScore);
+  return poll(population, scores, bestScore, evaluations, population.size());
+}
+
+
+void Termination::count (double bestScore) {
+  if (checked && !(bestScore < lastBestScore)) {
+    stagnant++;
+  }
+  else {
+    stagnant = 0;
+  }
+  lastBestScore = bestScore;
+  checked = true;
+}
+
+
+Criterion Termination::poll (const Population& population, const std::vector<double>& scores, double bestScore, double evaluations, double step) const {
+  // Check the target score:
+  if (bestScore <= target) {
+    return TERMINATE_TARGET;
+  }
+
+  // Check the stagnation:
+  if (stagnation > 0 && stagnant >= stagnation) {
+    return TERMINATE_STAGNATION;
+  }
+
+  // Check the spread of population scores:
+  if (scoreTolerance > 0) {
+    const std::pair<std::vector<double>::const_iterator, std::vector<double>::const_iterator> range = std::minmax_element(scores.begin(), scores.end());
+    if (*range.second - *range.first < scoreTolerance) {
+      return TERMINATE_SCORE_TOLERANCE;
+    }
+  }
+
+  // Check the spread of each parameter:
+  if (parameterTolerance > 0) {
+    bool converged = true;
+    for (int j = 0; j < population.width() && converged; j++) {
+      double lowest = population(0, j);
+      double highest = lowest;
+      for (int i = 1; i < population.size(); i++) {
+        lowest = std::min(lowest, population(i, j));
+        highest = std::max(highest, population(i, j));
+      }
+      converged = highest - lowest < parameterTolerance;
+    }
+    if (converged) {
+      return TERMINATE_PARAMETER_TOLERANCE;
+    }
+  }
+
+  // Check if the next step would exceed the evaluation budget:
+  if (evaluations + step > maxEvaluations) {
+    return TERMINATE_EVALUATIONS;
+  }
+
+  // Check the wall-clock:
+  if (timeLimit < std::numeric_limits<double>::infinity()) {
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    if (elapsed.count() >= timeLimit) {
+      return TERMINATE_DEADLINE;
+    }
+  }
+
+  // Done, carry on:
+  return TERMINATE_NONE;
+}
@@ -0,0 +1,177 @@
+#include <vector>
+#include <chrono>
+#include "population.h"
+
+#ifndef deflex_termination_h
+#define deflex_termination_h
+
+/**
+ * Provides the termination criteria.
+ */
+enum Criterion {
+  /**
+   * None has fired, ie. the evolution ran for all iterations.
+   */
+  TERMINATE_NONE,
+
+  /**
+   * The best score reached the target score.
+   */
+  TERMINATE_TARGET,
+
+  /**
+   * The best score has not improved for a number of generations.
+   */
+  TERMINATE_STAGNATION,
+
+  /**
+   * The spread of population scores fell below the tolerance.
+   */
+  TERMINATE_SCORE_TOLERANCE,
+
+  /**
+   * The spread of each parameter over the population fell below the
+   * tolerance.
+   */
+  TERMINATE_PARAMETER_TOLERANCE,
+
+  /**
+   * The next generation would exceed the maximum number of objective
+   * function evaluations.
+   */
+  TERMINATE_EVALUATIONS,
+
+  /**
+   * The wall-clock time limit has passed.
+   */
+  TERMINATE_DEADLINE
+};
+
+
+/**
+ * Gives the name of the termination criterion as reported in results.
+ *
+ * @param criterion The termination criterion.
+ * @return One of `"iterations"`, `"target"`, `"stagnation"`,
+ *         `"scoreTolerance"`, `"parameterTolerance"`, `"evaluations"`
+ *         or `"deadline"`.
+ */
+const char* criterionName (Criterion criterion);
+
+
+/**
+ * Checks the termination criteria at generation boundaries.
+ *
+ * Criteria are checked in the order they are declared and the first
+ * one met fires. Disabled criteria cost nothing, and the parameter
+ * spread, the only one which is not constant time, is computed only
+ * if enabled.
+ */
+class Termination {
+public:
+  /**
+   * Starts the wall-clock.
+   *
+   * @param target             Target score (`-Inf` disables it).
+   * @param stagnation         Number of generations without improvement (`0` disables it).
+   * @param scoreTolerance     Tolerance of the population score spread (`0` disables it).
+   * @param parameterTolerance Tolerance of the parameter spreads (`0` disables it).
+   * @param maxEvaluations     Maximum number of evaluations (`Inf` disables it).
+   * @param timeLimit          Wall-clock time limit in seconds (`Inf` disables it).
+   */
+  Termination (double target, int stagnation, double scoreTolerance, double parameterTolerance, double maxEvaluations, double timeLimit);
+
+  /**
+   * Checks the termination criteria after a generation.
+   *
+   * It is to be called after each generation, including the initial
+   * one, so that generations without improvement can be counted.
+   *
+   * @param population  The population.
+   * @param scores      The population scores.
+   * @param bestScore   The best score.
+   * @param evaluations Number of evaluations so far.
+   * @return The criterion fired, `TERMINATE_NONE` if none.
+   */
+  Criterion check (const Population& population, const std::vector<double>& scores, double bestScore, double evaluations);
+
+  /**
+   * Counts a generation, with or without improvement.
+   *
+   * @param bestScore The best score.
+   */
+  void count (double bestScore);
+
+  /**
+   * Checks the termination criteria without counting a generation.
+   *
+   * This is for steady-state evolution, where criteria are checked
+   * after each evaluation while generations are counted every
+   * `popsize` evaluations.
+   *
+   * @param population  The population.
+   * @param scores      The population scores.
+   * @param bestScore   The best score.
+   * @param evaluations Number of evaluations so far.
+   * @param step        Number of evaluations of the next step, which must not exceed the evaluation budget.
+   * @return The criterion fired, `TERMINATE_NONE` if none.
+   */
+  Criterion poll (const Population& population, const std::vector<double>& scores, double bestScore, double evaluations, double step) const;
+
+  /**
+   * @return Best score as of the last check.
+   */
+  double lastBest () const {
+    return lastBestScore;
+  }
+
+  /**
+   * @return Number of generations without improvement so far.
+   */
+  int stagnantGenerations () const {
+    return stagnant;
+  }
+
+  /**
+   * Resumes counting generations without improvement from a checkpoint.
+   * The wall-clock restarts at construction regardless.
+   *
+   * @param lastBestScore Best score as of the last check.
+   * @param stagnant      Number of generations without improvement so far.
+   */
+  void resume (double lastBestScore, int stagnant) {
+    this->lastBestScore = lastBestScore;
+    this->stagnant = stagnant;
+    this->checked = true;
+  }
+
+private:
+  double target;
+  int stagnation;
+  double scoreTolerance;
+  double parameterTolerance;
+  double maxEvaluations;
+  double timeLimit;
+
+  /**
+   * Wall-clock time at the start.
+   */
+  std::chrono::steady_clock::time_point start;
+
+  /**
+   * Best score as of the last check.
+   */
+  double lastBestScore;
+
+  /**
+   * Number of generations without improvement so far.
+   */
+  int stagnant;
+
+  /**
+   * Whether checked before.
+   */
+  bool checked;
+};
+
+#endif
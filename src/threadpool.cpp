@@ -0,0 +1,90 @@
+#include "threadpool.h"
+
+ThreadPool::ThreadPool (int size) : task(NULL), count(0), next(0), pending(0), batch(0), stopping(false) {
+  for (int i = 1; i < size; i++) {
+    workers.push_back(std::thread(&ThreadPool::work, this));
+  }
+}
+
+
+ThreadPool::~ThreadPool () {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stopping = true;
+  }
+  wakeup.notify_all();
+  for (size_t i = 0; i < workers.size(); i++) {
+    workers[i].join();
+  }
+}
+
+
+void ThreadPool::run (int count, const std::function<void(int)>& task) {
+  std::unique_lock<std::mutex> lock(mutex);
+
+  // Publish the batch:
+  this->task = &task;
+  this->count = count;
+  this->next = 0;
+  this->pending = count;
+  this->error = std::exception_ptr();
+  this->batch++;
+  wakeup.notify_all();
+
+  // Take tasks ourselves:
+  drain(lock);
+
+  // Wait for the remaining tasks:
+  finished.wait(lock, [this] { return pending == 0; });
+  this->task = NULL;
+
+  // Propagate the error, if any:
+  if (error) {
+    std::rethrow_exception(error);
+  }
+}
+
+
+void ThreadPool::work () {
+  long seen = 0;
+  std::unique_lock<std::mutex> lock(mutex);
+  while (true) {
+    // Wait for a new batch or the stop signal:
+    wakeup.wait(lock, [this, seen] { return stopping || batch != seen; });
+    if (stopping) {
+      return;
+    }
+    seen = batch;
+
+    // Take tasks:
+    drain(lock);
+  }
+}
+
+
+void ThreadPool::drain (std::unique_lock<std::mutex>& lock) {
+  while (task != NULL && next < count) {
+    // Take the next task:
+    const int index = next++;
+    const std::function<void(int)>& current = *task;
+
+    // Run it without holding the lock:
+    lock.unlock();
+    std::exception_ptr failure;
+    try {
+      current(index);
+    }
+    catch (...) {
+      failure = std::current_exception();
+    }
+    lock.lock();
+
+    // Record the outcome:
+    if (failure && !error) {
+      error = failure;
+    }
+    if (--pending == 0) {
+      finished.notify_all();
+    }
+  }
+}
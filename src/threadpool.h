@@ -0,0 +1,68 @@
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <exception>
+#include <functional>
+#include <condition_variable>
+
+
+#ifndef deflex_threadpool_h
+#define deflex_threadpool_h
+
+/**
+ * Provides a fixed-size pool of worker threads which run batches of
+ * indexed tasks.
+ *
+ * Tasks must not call into R. The first exception thrown by a task is
+ * re-thrown to the caller of `run` once all tasks of the batch are
+ * finished.
+ */
+class ThreadPool {
+public:
+  /**
+   * Starts the worker threads.
+   *
+   * @param size Number of threads, including the calling thread.
+   */
+  explicit ThreadPool (int size);
+
+  /**
+   * Stops and joins the worker threads.
+   */
+  ~ThreadPool ();
+
+  /**
+   * Runs tasks `[0, count)` on the pool and waits until all are done.
+   *
+   * The calling thread takes tasks, too.
+   *
+   * @param count Number of tasks.
+   * @param task  The task to run with the task index.
+   */
+  void run (int count, const std::function<void(int)>& task);
+
+  /**
+   * @return Number of threads, including the calling thread.
+   */
+  int size () const {
+    return workers.size() + 1;
+  }
+
+private:
+  void work ();
+  void drain (std::unique_lock<std::mutex>& lock);
+
+  std::vector<std::thread> workers;
+  std::mutex mutex;
+  std::condition_variable wakeup;
+  std::condition_variable finished;
+  const std::function<void(int)>* task;
+  std::exception_ptr error;
+  int count;
+  int next;
+  int pending;
+  long batch;
+  bool stopping;
+};
+
+#endif
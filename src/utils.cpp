@@ -16,21 +16,6 @@ std::vector<int> createSequence (int from, int to) {
 }
 
 
-std::vector<int> chooseRandom (std::vector<int> input, int count) {
-  // Get a copy of the input:
-  std::vector<int> copied(input);
-
-  // Shuffle copied:
-  std::random_shuffle(copied.begin(), copied.end(), _runifIntWrapper);
-
-  // Slice the first `count` elements:
-  copied.resize(count);
-
-  // Done, return the copied, shuffled, sliced vector:
-  return copied;
-}
-
-
 bool _terminate(Rcpp::Function predicate, int generation) {
   // Get the value:
   const Rcpp::NumericVector pred(predicate(generation));
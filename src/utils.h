@@ -16,13 +16,56 @@ std::vector<int> createSequence (int from, int to);
 
 
 /**
- * Chooses a number of elements randomly from the given input vector.
+ * Picks a number of elements of a sequence randomly without replacement.
  *
- * @param input The input vector from which elements will be chosen.
- * @param count The number of elements to be chosen.
- * @return      A vector of elements randomly chosen from the input vector.
+ * This is a partial Fisher-Yates shuffle which, instead of shuffling a
+ * copy of the sequence, remembers only the positions overwritten so
+ * far. It takes `count` draws and O(count^2) time without allocating,
+ * which suits the handful of donors DE strategies pick. For the same
+ * draws, it picks the same elements as Rcpp's `sample` without
+ * replacement.
+ *
+ * @param sequence  Gives the element at a position of the sequence.
+ * @param size      Size of the sequence.
+ * @param count     The number of elements to be picked.
+ * @param index     Gives a random integer from `[0, n)` for `n`.
+ * @param picked    Picked elements (output of `count` elements).
+ * @param positions Scratch space of `count` elements.
+ * @param values    Scratch space of `count` elements.
  */
-std::vector<int> chooseRandom (std::vector<int> input, int count);
+template <typename Sequence, typename Index>
+inline void pickRandom (Sequence sequence, int size, int count, Index index, int* picked, int* positions, int* values) {
+  // Number of overwritten positions:
+  int overwritten = 0;
+
+  // Pick elements one by one while shrinking the sequence:
+  for (int i = 0; i < count; i++, size--) {
+    // Draw the position and find out the elements at the position and at the end:
+    const int j = index(size);
+    const int last = size - 1;
+    int slot = overwritten;
+    int element = sequence(j);
+    int lastElement = sequence(last);
+    for (int k = 0; k < overwritten; k++) {
+      if (positions[k] == j) {
+        slot = k;
+        element = values[k];
+      }
+      if (positions[k] == last) {
+        lastElement = values[k];
+      }
+    }
+
+    // Pick the element:
+    picked[i] = element;
+
+    // Move the last element to the position:
+    if (slot == overwritten) {
+      positions[overwritten++] = j;
+    }
+    values[slot] = lastElement;
+  }
+}
 
 
 /**
@@ -72,14 +115,22 @@ inline int _runifIntWrapper (const int n) {
  * @return Trimmed vector.
  */
 inline Rcpp::NumericVector trimVector (Rcpp::NumericVector vector, const Rcpp::NumericVector upper, const Rcpp::NumericVector lower) {
-  // First, trim for the upper:
-  vector = ifelse(vector > upper, upper, vector);
-
-  // Now, trim for the lower:
-  vector = ifelse(vector < lower, lower, vector);
+  // Work on a copy, in a single pass without temporaries:
+  Rcpp::NumericVector retval = Rcpp::clone(vector);
+  for (int i = 0; i < retval.size(); i++) {
+    // First, trim for the upper:
+    if (retval[i] > upper[i]) {
+      retval[i] = upper[i];
+    }
+
+    // Now, trim for the lower:
+    if (retval[i] < lower[i]) {
+      retval[i] = lower[i];
+    }
+  }
 
   // Done, return:
-  return vector;
+  return retval;
 }
 
 
@@ -92,13 +143,26 @@ inline Rcpp::NumericVector trimVector (Rcpp::NumericVector vector, const Rcpp::N
  * @return Trimmed vector with bouncing back.
  */
 inline Rcpp::NumericVector bounceBack (Rcpp::NumericVector vector, const Rcpp::NumericVector upper, const Rcpp::NumericVector lower) {
-  // First, trim for the upper:
-  vector = ifelse(vector > upper, upper - (unif_rand() * (upper - lower)), vector);
-
-  // Now, trim for the lower:
-  vector = ifelse(vector < lower, lower + (unif_rand() * (upper - lower)), vector);
+  // Work on a copy without temporaries:
+  Rcpp::NumericVector retval = Rcpp::clone(vector);
+
+  // First, trim for the upper (with a single random number for all elements):
+  const double upperRandom = unif_rand();
+  for (int i = 0; i < retval.size(); i++) {
+    if (retval[i] > upper[i]) {
+      retval[i] = upper[i] - (upperRandom * (upper[i] - lower[i]));
+    }
+  }
+
+  // Now, trim for the lower (with a single random number for all elements):
+  const double lowerRandom = unif_rand();
+  for (int i = 0; i < retval.size(); i++) {
+    if (retval[i] < lower[i]) {
+      retval[i] = lower[i] + (lowerRandom * (upper[i] - lower[i]));
+    }
+  }
 
   // Done, return:
-  return vector;
+  return retval;
 }
 #endif